@@ -0,0 +1,329 @@
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+#include "ai.hpp"
+#include "instrument.hpp"
+
+//Value of a board the game is lost on, below anything the evaluation can return
+constexpr double lossValue = -1e9;
+
+//Constructor taking the search settings and the pool to search on, searching on the calling thread when it is null
+//The pool must not be running other work while a move is chosen
+aiPlayer::aiPlayer(const aiOptions &setOptions, workStealingPool *setPool) : options(setOptions), pool(setPool), table(setOptions.tableEntries), tableStats(setPool ? setPool->returnNumThreads() : 1)
+{
+	options.lookahead = std::max(0, std::min(options.lookahead, maxPreviewLength));
+}
+
+//Returns whether the time budget of the current move has run out
+bool aiPlayer::pastDeadline()
+{
+	if (options.timeBudget.count() == 0)
+	{
+		return false;
+	}
+	if (outOfTime.load(std::memory_order_relaxed))
+	{
+		return true;
+	}
+	if (std::chrono::steady_clock::now() >= deadline)
+	{
+		outOfTime.store(true, std::memory_order_relaxed);
+		return true;
+	}
+
+	return false;
+}
+
+//Returns the value of a board with piecesLeft preview pieces still to place, starting at previewIndex, searched by the given worker
+//Each piece is placed wherever gives the best value; cleared lines add their weight along the way
+double aiPlayer::search(const board &field, const gameState &game, int previewIndex, int piecesLeft, int worker)
+{
+	if (piecesLeft == 0)
+	{
+		return evaluateBoard(field, options.weights);
+	}
+	if (pastDeadline())
+	{
+		return lossValue;
+	}
+
+	//The preview is the same for the whole search, so a board's value only depends on how far into it the search is
+	std::uint64_t key = field.returnHash() ^ (std::uint64_t(previewIndex * maxPreviewLength + piecesLeft) * 0x9E3779B97F4A7C15ull);
+	double value;
+	if (table.lookup(key, value, tableStats[worker].table))
+	{
+		return value;
+	}
+
+	globalCounters.add(counterSearchNodes);
+	int shape = game.returnPreview(previewIndex);
+	placementList moves;
+	findPlacements(field, tetromino(shape), moves);
+	value = lossValue;
+	for (int i = 0; i < moves.returnCount(); i++)
+	{
+		board next = field;
+		int lines = placePiece(next, shape, moves.returnPlacement(i), previewIndex + 1 < game.returnPreviewCount() ? game.returnPreview(previewIndex + 1) : -1);
+		if (lines >= 0)
+		{
+			value = std::max(value, lines * options.weights.lines + search(next, game, previewIndex + 1, piecesLeft - 1, worker));
+		}
+	}
+
+	//A search cut short by the deadline has not seen every placement
+	if (!outOfTime.load(std::memory_order_relaxed))
+	{
+		table.store(key, value, piecesLeft, tableStats[worker].table);
+	}
+	return value;
+}
+
+//Returns the best placement of the active tetromino, reachable from where it is now
+//With a time budget the lookahead deepens one piece at a time and the deepest finished search decides
+placement aiPlayer::chooseMove(const gameState &game)
+{
+	const tetromino &active = game.returnActive();
+	findPlacements(game.returnBoard(), active, candidates);
+	placement best = {std::int8_t(active.returnPosition().x), std::int8_t(active.returnPosition().y), std::int8_t(active.returnRotation())};
+	if (candidates.returnCount() == 0)
+	{
+		return best;
+	}
+
+	table.newSearch();
+	deadline = std::chrono::steady_clock::now() + options.timeBudget;
+	outOfTime.store(false, std::memory_order_relaxed);
+
+	//A search without a time limit goes straight to the full lookahead, which the game's preview may cut short
+	int lookahead = std::min(options.lookahead, game.returnPreviewCount());
+	int firstDepth = options.timeBudget.count() > 0 ? 0 : lookahead;
+	for (int depth = firstDepth; depth <= lookahead; depth++)
+	{
+		auto evaluate = [&](int worker, std::uint64_t begin, std::uint64_t end)
+		{
+			for (std::uint64_t i = begin; i < end; i++)
+			{
+				board next = game.returnBoard();
+				int lines = placePiece(next, active.returnShape(), candidates.returnPlacement(i), game.returnPreviewCount() > 0 ? game.returnPreview(0) : -1);
+				candidateValues[i] = lines < 0 ? lossValue : lines * options.weights.lines + search(next, game, 0, depth, worker);
+			}
+		};
+
+		if (pool)
+		{
+			pool->parallelFor(candidates.returnCount(), 1, evaluate);
+		}
+		else
+		{
+			evaluate(0, 0, candidates.returnCount());
+		}
+
+		//The search with no preview pieces never checks the clock, so there is always a finished depth to use
+		if (outOfTime.load(std::memory_order_relaxed))
+		{
+			break;
+		}
+
+		//Ties go to the first placement so that the choice does not depend on thread timing
+		int bestIndex = std::max_element(candidateValues, candidateValues + candidates.returnCount()) - candidateValues;
+		best = candidates.returnPlacement(bestIndex);
+	}
+
+	return best;
+}
+
+//Returns the first of the fewest left, right, turn, down and hard drop moves that take a tetromino to a placement,
+//or -1 when it can no longer get there
+int firstMoveToward(const board &field, const tetromino &start, placement target)
+{
+	//A tetromino straight above its placement hard drops there, locking without waiting out the lock delay
+	position p = start.returnPosition();
+	if (p.x == target.x && start.returnRotation() == target.rotation && p.y + dropDistance(start, field) == target.y)
+	{
+		return inputHardDrop;
+	}
+
+	//Input flag of the first move on the way to each state, 0 while the state has not been reached
+	//States are indexed from the highest hidden row, where pieces can be kicked to
+	std::uint8_t firstMove[numRotations][hiddenRows + numRows][numColumns];
+	std::memset(firstMove, 0, sizeof(firstMove));
+	placement queue[numRotations * (hiddenRows + numRows) * numColumns];
+	int queueEnd = 0;
+	queue[queueEnd++] = {std::int8_t(p.x), std::int8_t(p.y), std::int8_t(start.returnRotation())};
+
+	const std::uint8_t moves[] = {inputRotate, inputRotateCcw, inputRotateHalf, inputLeft, inputRight, inputDown};
+	const int turns[] = {1, -1, 2};
+	int shape = start.returnShape();
+	for (int queueStart = 0; queueStart < queueEnd; queueStart++)
+	{
+		placement current = queue[queueStart];
+		for (int i = 0; i < 6; i++)
+		{
+			placement next = current;
+			if (i < 3)
+			{
+				//Turns take the first kick that fits, as the game does
+				tetromino turned(shape);
+				turned.setPlacement(current.x, current.y, current.rotation);
+				if (!rotateWithKicks(turned, field, turns[i]))
+				{
+					continue;
+				}
+				next = {std::int8_t(turned.returnPosition().x), std::int8_t(turned.returnPosition().y), std::int8_t(turned.returnRotation())};
+			}
+			else
+			{
+				next.x += moves[i] == inputLeft ? -1 : moves[i] == inputRight ? 1 : 0;
+				next.y += moves[i] == inputDown ? 1 : 0;
+				if (!pieceFits(field, shape, next.rotation, next.x, next.y))
+				{
+					continue;
+				}
+			}
+
+			std::uint8_t &reached = firstMove[next.rotation][next.y + hiddenRows][next.x];
+			if (reached || (next.x == p.x && next.y == p.y && next.rotation == start.returnRotation()))
+			{
+				continue;
+			}
+
+			reached = queueStart == 0 ? moves[i] : firstMove[current.rotation][current.y + hiddenRows][current.x];
+			if (next.x == target.x && next.y == target.y && next.rotation == target.rotation)
+			{
+				return reached;
+			}
+			queue[queueEnd++] = next;
+		}
+	}
+
+	return -1;
+}
+
+//Returns the input to press on the next step of the game
+//A placement is chosen once for every new tetromino, and again if gravity carries it past the way there
+input aiPlayer::nextInput(const gameState &game)
+{
+	input in;
+	if (game.isGameOver())
+	{
+		return in;
+	}
+
+	const tetromino &active = game.returnActive();
+	if (!hasTarget || game.returnPiecesPlaced() != targetPiecesPlaced || active.returnPosition().y < lastY)
+	{
+		target = chooseMove(game);
+		hasTarget = true;
+		targetPiecesPlaced = game.returnPiecesPlaced();
+	}
+	lastY = active.returnPosition().y;
+
+	int move = firstMoveToward(game.returnBoard(), active, target);
+	if (move < 0)
+	{
+		target = chooseMove(game);
+		move = firstMoveToward(game.returnBoard(), active, target);
+	}
+
+	in.flags = move < 0 ? inputDown : move;
+	return in;
+}
+
+//Returns the transposition table counters of every search thread added up, for reporting how often it is hit
+transpositionStats aiPlayer::returnTableStats() const
+{
+	transpositionStats stats;
+	for (int i = 0; i < tableStats.size(); i++)
+	{
+		stats.add(tableStats[i].table);
+	}
+	return stats;
+}
+
+//Returns the column heights, holes and bumpiness of a board from its row masks
+boardFeatures measureBoard(const board &field)
+{
+	boardFeatures features;
+	int heights[numColumns] = {};
+	//Columns with a filled cell in any row above the current one
+	std::uint32_t covered = 0;
+	for (int y = 0; y < numRows; y++)
+	{
+		std::uint32_t row = field.returnRow(y);
+		features.holes += countSetBits(covered & ~row);
+
+		std::uint32_t tops = row & ~covered;
+		while (tops)
+		{
+			heights[lowestSetBit(tops)] = numRows - y;
+			tops &= tops - 1;
+		}
+		covered |= row;
+	}
+
+	for (int x = 0; x < numColumns; x++)
+	{
+		features.aggregateHeight += heights[x];
+		if (x + 1 < numColumns)
+		{
+			features.bumpiness += std::abs(heights[x] - heights[x + 1]);
+		}
+	}
+
+	return features;
+}
+
+//Returns the weighted sum of a board's features, leaving out lines, which are scored as they are cleared
+double evaluateBoard(const board &field, const evalWeights &weights)
+{
+	boardFeatures features = measureBoard(field);
+	return weights.aggregateHeight * features.aggregateHeight + weights.holes * features.holes + weights.bumpiness * features.bumpiness;
+}
+
+//Locks a tetromino of the given shape at a placement and clears the rows it completes, as a game step does
+//Returns the number of lines cleared, or -1 if the lock loses the game: a block is left above the top row, or the next
+//shape has no room where it spawns; with the next shape unknown, passed as -1, any shape without room loses
+int placePiece(board &field, int shape, placement move, int nextShape)
+{
+	tetromino placed(shape);
+	placed.setPlacement(move.x, move.y, move.rotation);
+	placed.decompose(field);
+	if (isLockedOut(placed))
+	{
+		return -1;
+	}
+
+	int lines = field.clearFullRows();
+	for (int next = 0; next < numShapes; next++)
+	{
+		if ((nextShape < 0 || next == nextShape) && !pieceFits(field, next, 0, numColumns / 2, 0))
+		{
+			return -1;
+		}
+	}
+	return lines;
+}
+
+//Reads the weights from four comma separated numbers: aggregate height, lines, holes and bumpiness
+evalWeights parseWeights(const std::string &text)
+{
+	evalWeights weights;
+	double *fields[] = {&weights.aggregateHeight, &weights.lines, &weights.holes, &weights.bumpiness};
+	std::istringstream in(text);
+	for (int i = 0; i < 4; i++)
+	{
+		char separator = ',';
+		if ((i > 0 && !(in >> separator)) || separator != ',' || !(in >> *fields[i]))
+		{
+			throw std::runtime_error("Weights must be four comma separated numbers: " + text);
+		}
+	}
+	if (!(in >> std::ws).eof())
+	{
+		throw std::runtime_error("Weights must be four comma separated numbers: " + text);
+	}
+
+	return weights;
+}
@@ -0,0 +1,92 @@
+#ifndef AI_HPP
+#define AI_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "board.hpp"
+#include "game.hpp"
+#include "movegen.hpp"
+#include "threadPool.hpp"
+#include "transposition.hpp"
+
+//Weights of the linear board evaluation; features that are bad for the player get negative weights
+struct evalWeights
+{
+	double aggregateHeight = -0.510066;
+	double lines = 0.760666;
+	double holes = -0.35663;
+	double bumpiness = -0.184483;
+};
+
+//Board features the evaluation weighs
+struct boardFeatures
+{
+	//Sum of the column heights
+	int aggregateHeight = 0;
+	//Empty cells with a filled cell above them in the same column
+	int holes = 0;
+	//Sum of the height differences of neighboring columns
+	int bumpiness = 0;
+};
+
+//Settings of the AI player
+struct aiOptions
+{
+	//Preview pieces searched past the active one, at most maxPreviewLength and the game's preview count
+	int lookahead = 1;
+	//Time a move may take before the search settles for the deepest lookahead it finished; 0 means no limit
+	//Without a limit every move is searched to the full lookahead, so games play the same every time
+	std::chrono::microseconds timeBudget{0};
+	evalWeights weights;
+	//Entries of the transposition table, rounded up to a power of two
+	int tableEntries = 1 << 14;
+};
+
+//Plays a game by searching every placement of the active tetromino and of the preview pieces after it,
+//then presses the same left, right, turn, down and hard drop inputs a player would to take the active tetromino there
+class aiPlayer
+{
+	private:
+		aiOptions options;
+		workStealingPool *pool;
+		transpositionTable table;
+		//Table counters of every search thread, each on its own cache line
+		struct alignas(64) workerTableStats
+		{
+			transpositionStats table;
+		};
+		std::vector<workerTableStats> tableStats;
+
+		//Values of the active tetromino's placements, filled in by the search threads
+		placementList candidates;
+		double candidateValues[maxPlacements];
+
+		std::chrono::steady_clock::time_point deadline;
+		std::atomic<bool> outOfTime{false};
+
+		bool hasTarget = false;
+		placement target;
+		int targetPiecesPlaced = 0;
+		int lastY = 0;
+
+		double search(const board &field, const gameState &game, int previewIndex, int piecesLeft, int worker);
+		bool pastDeadline();
+
+	public:
+		aiPlayer(const aiOptions &setOptions = aiOptions(), workStealingPool *setPool = nullptr);
+
+		placement chooseMove(const gameState &game);
+		input nextInput(const gameState &game);
+		transpositionStats returnTableStats() const;
+};
+
+boardFeatures measureBoard(const board &field);
+double evaluateBoard(const board &field, const evalWeights &weights);
+int placePiece(board &field, int shape, placement move, int nextShape);
+int firstMoveToward(const board &field, const tetromino &start, placement target);
+evalWeights parseWeights(const std::string &text);
+
+#endif
@@ -0,0 +1,252 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "game.hpp"
+#include "policy.hpp"
+#include "threadPool.hpp"
+
+//Options of a batch run
+struct batchOptions
+{
+	std::uint64_t games = 10000;
+	std::uint64_t seed = 1;
+	int threads = 0;
+	policyType policy = policyRandom;
+	int maxTicks = 100000;
+	gameRules rules;
+	boardSize size = {numColumns, numRows};
+	//Search settings of the AI policy; games are already spread over every thread, so each AI searches on its own
+	aiOptions ai;
+};
+
+//Totals kept by one worker so that workers never write to shared memory while playing
+struct alignas(64) workerArena
+{
+	std::vector<int> scores;
+	std::uint64_t lines = 0;
+	std::uint64_t pieces = 0;
+	std::uint64_t ticks = 0;
+	transpositionStats table;
+};
+
+//Prints how to call the batch runner
+void printUsage()
+{
+	std::cerr << "Usage: tetris_batch [--games N] [--seed S] [--threads T] [--policy idle|random|ai] [--max-ticks M] [--board WxH] [--randomizer classic|bag|history] [--preview N] [--lock-delay ticks] [--lookahead N] [--budget ms] [--weights h,l,o,b] [--table-entries N]\n";
+}
+
+//Reads the options from the command line
+batchOptions parseOptions(int argc, char **argv)
+{
+	batchOptions options;
+	for (int i = 1; i < argc; i++)
+	{
+		std::string arg = argv[i];
+		if (i + 1 >= argc)
+		{
+			throw std::runtime_error("Missing value for " + arg);
+		}
+
+		std::string value = argv[++i];
+		if (arg == "--games")
+		{
+			options.games = std::stoull(value);
+		}
+		else if (arg == "--seed")
+		{
+			options.seed = std::stoull(value);
+		}
+		else if (arg == "--threads")
+		{
+			options.threads = std::stoi(value);
+		}
+		else if (arg == "--policy")
+		{
+			options.policy = parsePolicy(value);
+		}
+		else if (arg == "--max-ticks")
+		{
+			options.maxTicks = std::stoi(value);
+		}
+		else if (arg == "--board")
+		{
+			options.size = parseBoardSize(value);
+		}
+		else if (arg == "--randomizer")
+		{
+			options.rules.randomizer = parseRandomizer(value);
+		}
+		else if (arg == "--preview")
+		{
+			options.rules.previewCount = std::stoi(value);
+		}
+		else if (arg == "--lock-delay")
+		{
+			options.rules.lockDelay = std::stoi(value);
+		}
+		else if (arg == "--lookahead")
+		{
+			options.ai.lookahead = std::stoi(value);
+		}
+		else if (arg == "--budget")
+		{
+			options.ai.timeBudget = std::chrono::microseconds(std::llround(std::stod(value) * 1000));
+		}
+		else if (arg == "--weights")
+		{
+			options.ai.weights = parseWeights(value);
+		}
+		else if (arg == "--table-entries")
+		{
+			options.ai.tableEntries = std::stoi(value);
+		}
+		else
+		{
+			throw std::runtime_error("Unknown option " + arg);
+		}
+	}
+
+	//The move generator and the AI are built for the standard board only
+	if (options.policy == policyAi && (options.size.width != numColumns || options.size.height != numRows))
+	{
+		throw std::runtime_error("The AI policy only plays on a " + std::to_string(numColumns) + "x" + std::to_string(numRows) + " board");
+	}
+
+	return options;
+}
+
+//Plays one game to a loss or to the tick limit on a board of the given size and adds it to a worker's totals
+template <int width, int height>
+void playGame(const batchOptions &options, unsigned seed, workerArena &arena)
+{
+	basicGameState<width, height> game(seed, options.rules);
+	inputPolicy policy(options.policy, seed, options.ai);
+	int ticks = 0;
+	while (!game.isGameOver() && ticks < options.maxTicks)
+	{
+		if constexpr (width == numColumns && height == numRows)
+		{
+			game.step(policy.nextInput(game));
+		}
+		else
+		{
+			game.step(policy.nextBlindInput());
+		}
+		ticks++;
+	}
+
+	arena.scores.push_back(game.returnScore());
+	arena.lines += game.returnLines();
+	arena.pieces += game.returnPiecesPlaced();
+	arena.ticks += ticks;
+	if (policy.returnAi())
+	{
+		arena.table.add(policy.returnAi()->returnTableStats());
+	}
+}
+
+//Returns the score at the given fraction of the sorted scores
+int percentile(const std::vector<int> &sortedScores, double fraction)
+{
+	std::size_t index = std::min(sortedScores.size() - 1, std::size_t(fraction * sortedScores.size()));
+	return sortedScores[index];
+}
+
+int main(int argc, char **argv)
+{
+	batchOptions options;
+	try
+	{
+		options = parseOptions(argc, argv);
+	}
+	catch(std::exception const &e)
+	{
+		std::cerr << "Exception: " << e.what() << "\n";
+		printUsage();
+		return 1;
+	}
+
+	workStealingPool pool(options.threads);
+	std::vector<workerArena> arenas(pool.returnNumThreads());
+	for (int i = 0; i < arenas.size(); i++)
+	{
+		arenas[i].scores.reserve(options.games / arenas.size() + 1);
+	}
+
+	auto start = std::chrono::steady_clock::now();
+
+	//Every game is played to a loss or to the tick limit by whichever worker takes it
+	//The board size is chosen once, outside the loop, so the games run on the kernels specialized for it
+	withBoardSize(options.size, [&](auto width, auto height)
+	{
+		pool.parallelFor(options.games, 64, [&](int worker, std::uint64_t begin, std::uint64_t end)
+		{
+			for (std::uint64_t i = begin; i < end; i++)
+			{
+				playGame<width(), height()>(options, gameSeed(options.seed, i), arenas[worker]);
+			}
+		});
+	});
+
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	//Merge the worker totals
+	std::vector<int> scores;
+	scores.reserve(options.games);
+	std::uint64_t lines = 0;
+	std::uint64_t pieces = 0;
+	std::uint64_t ticks = 0;
+	transpositionStats table;
+	for (int i = 0; i < arenas.size(); i++)
+	{
+		scores.insert(scores.end(), arenas[i].scores.begin(), arenas[i].scores.end());
+		lines += arenas[i].lines;
+		pieces += arenas[i].pieces;
+		ticks += arenas[i].ticks;
+		table.add(arenas[i].table);
+	}
+
+	if (scores.empty())
+	{
+		std::cout << "No games played\n";
+		return 0;
+	}
+
+	std::sort(scores.begin(), scores.end());
+	double games = scores.size();
+	std::uint64_t scoreTotal = 0;
+	for (int i = 0; i < scores.size(); i++)
+	{
+		scoreTotal += scores[i];
+	}
+
+	std::cout << "board        " << options.size.width << "x" << options.size.height << "\n";
+	std::cout << "games        " << scores.size() << " on " << pool.returnNumThreads() << " threads in " << seconds << " s\n";
+	std::cout << "games/sec    " << games / seconds << "\n";
+	std::cout << "ticks/sec    " << ticks / seconds << "\n";
+	std::cout << "score        mean " << scoreTotal / games << " min " << scores.front() << " p50 " << percentile(scores, 0.5) << " p90 " << percentile(scores, 0.9) << " p99 " << percentile(scores, 0.99) << " max " << scores.back() << "\n";
+	std::cout << "lines        total " << lines << " mean " << lines / games << "\n";
+	std::cout << "pieces       total " << pieces << " mean " << pieces / games << "\n";
+	if (table.probes > 0)
+	{
+		std::cout << "table        hit rate " << table.returnHitRate() << " of " << table.probes << " probes, " << table.overwrites << " of " << table.stores << " stores overwrote\n";
+	}
+
+	//Score distribution in power of two buckets
+	std::cout << "score distribution\n";
+	std::size_t bucketStart = 0;
+	for (int bound = 0; bucketStart < scores.size(); bound = bound == 0 ? 1 : bound * 2)
+	{
+		std::size_t bucketEnd = std::upper_bound(scores.begin() + bucketStart, scores.end(), bound) - scores.begin();
+		if (bucketEnd > bucketStart)
+		{
+			std::cout << "  <= " << bound << "\t" << bucketEnd - bucketStart << "\n";
+		}
+		bucketStart = bucketEnd;
+	}
+}
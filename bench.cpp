@@ -0,0 +1,1476 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+#include "boardView.hpp"
+#include "game.hpp"
+#include "handling.hpp"
+#include "instrument.hpp"
+#include "movegen.hpp"
+#include "policy.hpp"
+#include "protocol.hpp"
+#include "randomizer.hpp"
+#include "rollback.hpp"
+#include "transposition.hpp"
+
+//Every heap allocation made by the process, counted by the replaced global operator new
+std::atomic<std::uint64_t> allocationCount{0};
+
+void *operator new(std::size_t size)
+{
+	allocationCount.fetch_add(1, std::memory_order_relaxed);
+	if (void *memory = std::malloc(size ? size : 1))
+	{
+		return memory;
+	}
+	throw std::bad_alloc();
+}
+
+void *operator new[](std::size_t size)
+{
+	return operator new(size);
+}
+
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept
+{
+	allocationCount.fetch_add(1, std::memory_order_relaxed);
+	return std::malloc(size ? size : 1);
+}
+
+void *operator new[](std::size_t size, const std::nothrow_t &tag) noexcept
+{
+	return operator new(size, tag);
+}
+
+void operator delete(void *memory) noexcept
+{
+	std::free(memory);
+}
+
+void operator delete[](void *memory) noexcept
+{
+	std::free(memory);
+}
+
+void operator delete(void *memory, std::size_t) noexcept
+{
+	std::free(memory);
+}
+
+void operator delete[](void *memory, std::size_t) noexcept
+{
+	std::free(memory);
+}
+
+//Keeps the compiler from optimizing away a value that is computed but never used
+template<class T> inline void doNotOptimize(const T &value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+	asm volatile("" : : "r,m"(value) : "memory");
+#else
+	static volatile const T *sink;
+	sink = &value;
+#endif
+}
+
+//The vector of blocks implementation the bitboard replaced, kept to compare against
+namespace legacy
+{
+	//Tetromino holding its blocks in a vector that is rebuilt from the shape and rotation
+	class tetromino
+	{
+		private:
+			std::vector<block> blockList;
+			position p;
+			int shape;
+			int rotation;
+
+		public:
+			tetromino(int setShape) : shape(setShape), rotation(0)
+			{
+				p.x = numColumns / 2;
+				p.y = 0;
+				configBlockList();
+			}
+
+			void move(int direction)
+			{
+				p.x += direction == 1 ? -1 : direction == 3 ? 1 : 0;
+				p.y += direction == 2 ? 1 : direction == 0 ? -1 : 0;
+			}
+
+			void rotate(int direction)
+			{
+				rotation = (rotation + direction + numRotations) % numRotations;
+			}
+
+			position returnPosition()
+			{
+				return p;
+			}
+
+			std::vector<block> returnBlockList()
+			{
+				return blockList;
+			}
+
+			void configBlockList()
+			{
+				block blocks[blocksPerPiece];
+				for (int i = 0; i < blocksPerPiece; i++)
+				{
+					blocks[i].setPosition(pieceOffsets[shape][rotation][i].x, pieceOffsets[shape][rotation][i].y);
+					blocks[i].setColor(shape + 1);
+				}
+
+				if (blockList.size() == 0)
+				{
+					blockList.assign(blocks, blocks + blocksPerPiece);
+				}
+				else
+				{
+					std::copy(blocks, blocks + blocksPerPiece, blockList.begin());
+				}
+			}
+
+			std::vector<block> decompose(std::vector<block> setBlockList)
+			{
+				for (int i = 0; i < blockList.size(); i++)
+				{
+					block tempBlock = blockList[i];
+					tempBlock.setPosition(blockList[i].returnPosition().x + p.x, blockList[i].returnPosition().y + p.y);
+					setBlockList.push_back(tempBlock);
+				}
+
+				return setBlockList;
+			}
+	};
+
+	bool canMove(std::vector<tetromino> tetrominoList, std::vector<block> blockList, int direction)
+	{
+		tetromino activeTet = tetrominoList[0];
+		int dx = direction == 1 ? -1 : direction == 3 ? 1 : 0;
+		int dy = direction == 2 ? 1 : 0;
+		for (int i = 0; i < activeTet.returnBlockList().size(); i++)
+		{
+			int x = activeTet.returnBlockList()[i].returnPosition().x + activeTet.returnPosition().x;
+			int y = activeTet.returnBlockList()[i].returnPosition().y + activeTet.returnPosition().y;
+			if ((dx < 0 && x <= 0) || (dx > 0 && x >= numColumns - 1) || (dy > 0 && y >= numRows - 1))
+			{
+				return false;
+			}
+		}
+		for (int i = 0; i < blockList.size(); i++)
+		{
+			for (int j = 0; j < activeTet.returnBlockList().size(); j++)
+			{
+				if ((activeTet.returnBlockList()[j].returnPosition().x + activeTet.returnPosition().x + dx == blockList[i].returnPosition().x) && (activeTet.returnBlockList()[j].returnPosition().y + activeTet.returnPosition().y + dy == blockList[i].returnPosition().y))
+				{
+					return false;
+				}
+			}
+		}
+
+		return true;
+	}
+
+	bool canRotate(std::vector<tetromino> tetrominoList, std::vector<block> blockList, int direction)
+	{
+		tetromino activeTet = tetrominoList[tetrominoList.size() - 1];
+		activeTet.rotate(direction);
+		activeTet.configBlockList();
+		for (int i = 0; i < blockList.size(); i++)
+		{
+			for (int j = 0; j < activeTet.returnBlockList().size(); j++)
+			{
+				int x = activeTet.returnBlockList()[j].returnPosition().x + activeTet.returnPosition().x;
+				int y = activeTet.returnBlockList()[j].returnPosition().y + activeTet.returnPosition().y;
+				if (x < 0 || x >= numColumns || y < 0 || y >= numRows)
+				{
+					return false;
+				}
+				if (x == blockList[i].returnPosition().x && y == blockList[i].returnPosition().y)
+				{
+					return false;
+				}
+			}
+		}
+
+		return true;
+	}
+
+	bool isRowComplete(std::vector<block> blockList, int row)
+	{
+		bool columnFilled[numColumns] = {};
+		for (int i = 0; i < blockList.size(); i++)
+		{
+			if (blockList[i].returnPosition().y == row)
+			{
+				columnFilled[blockList[i].returnPosition().x] = true;
+			}
+		}
+
+		for (int i = 0; i < numColumns; i++)
+		{
+			if (!columnFilled[i])
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	std::vector<block> clearRow(std::vector<block> blockList, int row)
+	{
+		for (int i = 0; i < blockList.size(); i++)
+		{
+			if (blockList[i].returnPosition().y == row)
+			{
+				blockList.erase(blockList.begin() + i);
+				i--;
+				continue;
+			}
+
+			if (blockList[i].returnPosition().y < row)
+			{
+				blockList[i].move(2);
+			}
+		}
+
+		return blockList;
+	}
+
+	//Pushes garbage rows in from below the way a block list has to: every block moved up one row at a time, the ones
+	//pushed off the top erased, and a block added for every garbage cell
+	std::vector<block> addGarbageRows(std::vector<block> blockList, int count, int holeColumn)
+	{
+		for (int i = 0; i < blockList.size(); i++)
+		{
+			for (int j = 0; j < count; j++)
+			{
+				blockList[i].move(0);
+			}
+			if (blockList[i].returnPosition().y < 0)
+			{
+				blockList.erase(blockList.begin() + i);
+				i--;
+			}
+		}
+
+		for (int y = numRows - count; y < numRows; y++)
+		{
+			for (int x = 0; x < numColumns; x++)
+			{
+				if (x != holeColumn)
+				{
+					block tempBlock;
+					tempBlock.setPosition(x, y);
+					tempBlock.setColor(garbageColor);
+					blockList.push_back(tempBlock);
+				}
+			}
+		}
+
+		return blockList;
+	}
+
+	//State the old main loop kept in locals
+	struct loopState
+	{
+		std::vector<tetromino> tetrominoList;
+		std::vector<block> decomposedTetrominos;
+		std::vector<block> blockListActive;
+		int score = 0;
+	};
+
+	//One pass of the old main loop without drawing
+	void tick(loopState &state, int nextShape)
+	{
+		for (int i = 0; i < state.tetrominoList.size(); i++)
+		{
+			state.tetrominoList[i].configBlockList();
+			for (int j = 0; j < state.tetrominoList[i].returnBlockList().size(); j++)
+			{
+				block tempBlock;
+				tempBlock.setPosition(state.tetrominoList[i].returnBlockList()[j].returnPosition().x + state.tetrominoList[i].returnPosition().x, state.tetrominoList[i].returnBlockList()[j].returnPosition().y + state.tetrominoList[i].returnPosition().y);
+				tempBlock.setColor(state.tetrominoList[i].returnBlockList()[j].returnColor());
+				state.blockListActive.push_back(tempBlock);
+			}
+		}
+		for (int i = 0; i < state.decomposedTetrominos.size(); i++)
+		{
+			state.blockListActive.push_back(state.decomposedTetrominos[i]);
+		}
+
+		if (canMove(state.tetrominoList, state.decomposedTetrominos, 2))
+		{
+			state.tetrominoList[0].move(2);
+		}
+		else
+		{
+			state.decomposedTetrominos = state.tetrominoList[0].decompose(state.decomposedTetrominos);
+			state.tetrominoList.pop_back();
+			state.tetrominoList.push_back(tetromino(nextShape));
+		}
+
+		for (int i = 0; i < state.decomposedTetrominos.size(); i++)
+		{
+			if (state.decomposedTetrominos[i].returnPosition().x == numColumns / 2 && state.decomposedTetrominos[i].returnPosition().y == 0)
+			{
+				state.score = 0;
+				state.decomposedTetrominos.clear();
+			}
+		}
+
+		std::vector<int> linesCleared;
+		for (int i = 0; i < numRows; i++)
+		{
+			if (isRowComplete(state.decomposedTetrominos, i))
+			{
+				linesCleared.push_back(i);
+			}
+		}
+
+		state.score += scoreForLines(linesCleared.size());
+		while (linesCleared.size() > 0)
+		{
+			state.decomposedTetrominos = clearRow(state.decomposedTetrominos, linesCleared[0]);
+			linesCleared.erase(linesCleared.begin());
+		}
+
+		state.blockListActive.clear();
+	}
+}
+
+//Packs the sorted board cell indices of a tetromino's blocks into one key
+std::uint64_t cellKey(const tetromino &placed)
+{
+	std::uint8_t blocks[blocksPerPiece];
+	for (int i = 0; i < blocksPerPiece; i++)
+	{
+		position blockPosition = placed.returnBlock(i).returnPosition();
+		blocks[i] = blockPosition.y * numColumns + blockPosition.x;
+	}
+	std::sort(blocks, blocks + blocksPerPiece);
+
+	std::uint64_t key = 0;
+	for (int i = 0; i < blocksPerPiece; i++)
+	{
+		key = key << 8 | blocks[i];
+	}
+	return key;
+}
+
+//Placement search calling canMove and rotateWithKicks one move at a time, the way it had to be done before findPlacements
+//Returns the locked cells of every placement that does not lock out, sorted and without duplicates
+std::vector<std::uint64_t> stepwisePlacements(const board &field, const tetromino &start)
+{
+	bool visited[numRotations][hiddenRows + numRows][numColumns] = {};
+	std::vector<tetromino> queue(1, start);
+	visited[start.returnRotation()][start.returnPosition().y + hiddenRows][start.returnPosition().x] = true;
+	std::vector<std::uint64_t> cells;
+	const int turns[] = {1, -1, 2};
+	for (int i = 0; i < queue.size(); i++)
+	{
+		tetromino current = queue[i];
+		if (!canMove(current, field, 2) && !isLockedOut(current))
+		{
+			cells.push_back(cellKey(current));
+		}
+
+		for (int move = 0; move < 6; move++)
+		{
+			tetromino next = current;
+			if (move < 3 && canMove(current, field, move + 1))
+			{
+				next.move(move + 1);
+			}
+			else if (move < 3 || !rotateWithKicks(next, field, turns[move - 3]))
+			{
+				continue;
+			}
+
+			bool &seen = visited[next.returnRotation()][next.returnPosition().y + hiddenRows][next.returnPosition().x];
+			if (!seen)
+			{
+				seen = true;
+				queue.push_back(next);
+			}
+		}
+	}
+
+	std::sort(cells.begin(), cells.end());
+	cells.erase(std::unique(cells.begin(), cells.end()), cells.end());
+	return cells;
+}
+
+//Returns the locked cells of every placement findPlacements lists, in the form stepwisePlacements returns
+std::vector<std::uint64_t> placementCells(const tetromino &start, const placementList &moves)
+{
+	std::vector<std::uint64_t> cells;
+	for (int i = 0; i < moves.returnCount(); i++)
+	{
+		tetromino placed = start;
+		placed.setPlacement(moves.returnPlacement(i).x, moves.returnPlacement(i).y, moves.returnPlacement(i).rotation);
+		cells.push_back(cellKey(placed));
+	}
+
+	std::sort(cells.begin(), cells.end());
+	return cells;
+}
+
+//Rows a tetromino can fall found by testing one row down at a time, the way gravity moves it
+int stepwiseDrop(const tetromino &start, const board &field)
+{
+	tetromino falling = start;
+	int distance = 0;
+	while (canMove(falling, field, 2))
+	{
+		falling.move(2);
+		distance++;
+	}
+
+	return distance;
+}
+
+//Stack of locked blocks to benchmark against
+struct benchBoard
+{
+	std::string name;
+	board field;
+	std::vector<block> blockList;
+};
+
+//Builds a stack whose rows from firstRow down are filled except for one hole per row
+//With completeRows set, that many of the bottom rows are left without a hole
+benchBoard makeBoard(const std::string &name, int firstRow, int completeRows)
+{
+	benchBoard stack;
+	stack.name = name;
+	std::uint32_t holeSeed = 12345;
+	for (int y = firstRow; y < numRows; y++)
+	{
+		holeSeed = holeSeed * 1103515245u + 12345u;
+		int hole = (holeSeed >> 16) % numColumns;
+		for (int x = 0; x < numColumns; x++)
+		{
+			if (x == hole && y < numRows - completeRows)
+			{
+				continue;
+			}
+
+			stack.field.fillCell(x, y, 1 + (x + y) % numShapes);
+			block tempBlock;
+			tempBlock.setPosition(x, y);
+			tempBlock.setColor(1 + (x + y) % numShapes);
+			stack.blockList.push_back(tempBlock);
+		}
+	}
+
+	return stack;
+}
+
+//Result of one benchmark
+struct benchResult
+{
+	double nsPerOp;
+	double allocationsPerOp;
+};
+
+//Runs body in doubling batches until a batch takes at least minSeconds and returns the cost of one call
+template<class F> benchResult measure(F body, double minSeconds)
+{
+	std::uint64_t iterations = 1;
+	while (true)
+	{
+		std::uint64_t allocationsBefore = allocationCount.load(std::memory_order_relaxed);
+		auto start = std::chrono::steady_clock::now();
+		for (std::uint64_t i = 0; i < iterations; i++)
+		{
+			body(i);
+		}
+		double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		std::uint64_t allocations = allocationCount.load(std::memory_order_relaxed) - allocationsBefore;
+
+		if (seconds >= minSeconds || iterations >= (1ull << 40))
+		{
+			return {seconds * 1e9 / iterations, double(allocations) / iterations};
+		}
+		iterations *= 2;
+	}
+}
+
+//Prints one line of the result table if the benchmark name contains the filter
+template<class F> void runBenchmark(const std::string &filter, const std::string &name, const std::string &implementation, const std::string &boardName, F body)
+{
+	std::string fullName = name + "/" + implementation + "/" + boardName;
+	if (fullName.find(filter) == std::string::npos)
+	{
+		return;
+	}
+
+	benchResult result = measure(body, 0.2);
+	std::cout << std::left << std::setw(40) << fullName << std::right << std::setw(14) << std::fixed << std::setprecision(1) << result.nsPerOp << std::setw(14) << std::setprecision(2) << result.allocationsPerOp << "\n";
+}
+
+//Plays key events through an input handler in steps of stepLength nanoseconds up to endTime,
+//returning the side moves the step inputs make, right positive, and the largest repeat count of a step
+std::int64_t handledMoves(const handlingSettings &settings, const std::vector<keyEvent> &events, std::int64_t stepLength, std::int64_t endTime, int &maxRepeats)
+{
+	inputHandler handler(settings);
+	keyEventQueue queue;
+	for (int i = 0; i < events.size(); i++)
+	{
+		queue.push(events[i]);
+	}
+
+	std::int64_t moves = 0;
+	maxRepeats = 0;
+	for (std::int64_t stepEnd = stepLength; stepEnd <= endTime; stepEnd += stepLength)
+	{
+		input in = handler.nextStep(queue, stepEnd);
+		int sideMoves = (in.flags & (inputLeft | inputRight)) ? in.repeats + 1 : 0;
+		moves += (in.flags & inputLeft) ? -sideMoves : sideMoves;
+		maxRepeats = std::max<int>(maxRepeats, in.repeats);
+	}
+	return moves;
+}
+
+//Plays random inputs on a board of the given size, checking after every step that the kept hash matches a rescan,
+//that the column masks match the rows and that no complete row is left standing
+//Returns the number of lines cleared, or -1 with the failure printed
+template <int width, int height>
+int checkBoardSize(int steps)
+{
+	typedef basicBoard<width, height> boardType;
+	basicGameState<width, height> game(17);
+	inputPolicy policy(policyRandom, 17);
+	int lines = 0;
+	for (int i = 0; i < steps; i++)
+	{
+		lines += game.step(policy.nextBlindInput()).linesCleared;
+		if (game.isGameOver())
+		{
+			game.restart();
+		}
+		//Some garbage keeps arriving, so that its rows move the masks of every width too
+		if (i % 500 == 0)
+		{
+			game.receiveGarbage(1 + i / 500 % 3, i / 500 % width);
+		}
+
+		const boardType &field = game.returnBoard();
+		bool consistent = field.returnHash() == field.computeHash();
+		for (int y = 0; y < height; y++)
+		{
+			consistent = consistent && !field.isRowComplete(y);
+			for (int x = 0; x < width; x++)
+			{
+				consistent = consistent && ((field.returnColumn(x) >> y) & 1) == ((field.returnRow(y) >> x) & 1);
+			}
+		}
+		if (!consistent)
+		{
+			std::cerr << "The " << width << "x" << height << " board is inconsistent at step " << i << "\n";
+			return -1;
+		}
+	}
+
+	return lines;
+}
+
+int main(int argc, char **argv)
+{
+	std::string filter = argc > 1 ? argv[1] : "";
+
+	std::vector<benchBoard> stacks;
+	stacks.push_back(makeBoard("empty", numRows, 0));
+	stacks.push_back(makeBoard("half", numRows / 2, 0));
+	stacks.push_back(makeBoard("near-full", 4, 0));
+	stacks.push_back(makeBoard("near-full-4-lines", 4, 4));
+
+	//Both placement searches must find the same placements, with none listed twice, before either is timed
+	for (int b = 0; b < stacks.size(); b++)
+	{
+		for (int shape = 0; shape < numShapes; shape++)
+		{
+			tetromino spawned(shape);
+			placementList moves;
+			findPlacements(stacks[b].field, spawned, moves);
+			if (placementCells(spawned, moves) != stepwisePlacements(stacks[b].field, spawned))
+			{
+				std::cerr << "findPlacements disagrees with the stepwise search for shape " << shape << " on " << stacks[b].name << "\n";
+				return 1;
+			}
+		}
+	}
+
+	//On a stack reaching the top row, where most places to land leave blocks above the board, every listed placement must
+	//lock inside it
+	{
+		board nearlyFull;
+		for (int y = 1; y < numRows; y++)
+		{
+			for (int x = 0; x < numColumns; x++)
+			{
+				if (x != (y * 3) % numColumns)
+				{
+					nearlyFull.fillCell(x, y, 1);
+				}
+			}
+		}
+		for (int shape = 0; shape < numShapes; shape++)
+		{
+			tetromino spawned(shape);
+			placementList moves;
+			findPlacements(nearlyFull, spawned, moves);
+			for (int i = 0; i < moves.returnCount(); i++)
+			{
+				placement move = moves.returnPlacement(i);
+				tetromino placed(shape);
+				placed.setPlacement(move.x, move.y, move.rotation);
+				if (isLockedOut(placed))
+				{
+					std::cerr << "findPlacements listed a placement of shape " << shape << " that locks out\n";
+					return 1;
+				}
+			}
+			if (placementCells(spawned, moves) != stepwisePlacements(nearlyFull, spawned))
+			{
+				std::cerr << "findPlacements disagrees with the stepwise search for shape " << shape << " on a nearly full board\n";
+				return 1;
+			}
+		}
+	}
+
+	//Kicks matter most on ragged stacks full of overhangs, so the placement searches must also agree on random boards
+	std::uint32_t noiseSeed = 777;
+	for (int b = 0; b < 300; b++)
+	{
+		board noisy;
+		int top = 4 + b % 14;
+		for (int y = top; y < numRows; y++)
+		{
+			for (int x = 0; x < numColumns; x++)
+			{
+				noiseSeed = noiseSeed * 1103515245u + 12345u;
+				if ((noiseSeed >> 16) % 100 < 45)
+				{
+					noisy.fillCell(x, y, 1);
+				}
+			}
+		}
+
+		for (int shape = 0; shape < numShapes; shape++)
+		{
+			tetromino spawned(shape);
+			placementList moves;
+			findPlacements(noisy, spawned, moves);
+			if (placementCells(spawned, moves) != stepwisePlacements(noisy, spawned))
+			{
+				std::cerr << "findPlacements disagrees with the stepwise search for shape " << shape << " on random board " << b << "\n";
+				return 1;
+			}
+		}
+	}
+
+	//The drop distance read from the column masks must match falling one row at a time, for every shape,
+	//rotation and column the piece fits at from the spawn row
+	for (int b = 0; b < stacks.size(); b++)
+	{
+		for (int shape = 0; shape < numShapes; shape++)
+		{
+			for (int rotation = 0; rotation < numRotations; rotation++)
+			{
+				for (int x = 0; x < numColumns; x++)
+				{
+					tetromino start(shape);
+					start.setPlacement(x, start.returnPosition().y, rotation);
+					if (pieceFits(stacks[b].field, shape, rotation, x, start.returnPosition().y) && dropDistance(start, stacks[b].field) != stepwiseDrop(start, stacks[b].field))
+					{
+						std::cerr << "dropDistance disagrees with falling row by row for shape " << shape << " on " << stacks[b].name << "\n";
+						return 1;
+					}
+				}
+			}
+		}
+	}
+
+	//The incrementally kept board hash must match a full rehash through every lock and line clear of a game
+	gameState hashedGame(7);
+	inputPolicy hashedPolicy(policyAi, 7);
+	for (int i = 0; i < 20000; i++)
+	{
+		hashedGame.step(hashedPolicy.nextInput(hashedGame));
+		if (hashedGame.returnBoard().returnHash() != hashedGame.returnBoard().computeHash())
+		{
+			std::cerr << "Board hash drifted from a full rehash at step " << i << "\n";
+			return 1;
+		}
+		//The column masks are kept up to date alongside, so the active tetromino's drop distance stays exact
+		if (dropDistance(hashedGame.returnActive(), hashedGame.returnBoard()) != stepwiseDrop(hashedGame.returnActive(), hashedGame.returnBoard()))
+		{
+			std::cerr << "Column masks drifted from the row masks at step " << i << "\n";
+			return 1;
+		}
+		if (hashedGame.isGameOver())
+		{
+			hashedGame.restart();
+		}
+	}
+
+	//Random input keeps moving and turning pieces on the stack, but a piece must still lock within its capped lock delay
+	//restarts and a fall from the top at the slowest gravity
+	const int maxTicksPerPiece = (maxLockResets + 1) * gameRules().lockDelay + (hiddenRows + numRows) * defaultGravity.ticksPerRow[0];
+	for (unsigned seed = 0; seed < 200; seed++)
+	{
+		gameState floatingGame(seed);
+		inputPolicy floatingPolicy(policyRandom, seed);
+		int ticksSinceLock = 0;
+		for (int i = 0; i < 100000 && !floatingGame.isGameOver(); i++)
+		{
+			ticksSinceLock = floatingGame.step(floatingPolicy.nextInput(floatingGame)).locked ? 0 : ticksSinceLock + 1;
+			if (ticksSinceLock > maxTicksPerPiece)
+			{
+				std::cerr << "A piece stayed unlocked for " << ticksSinceLock << " ticks in random game " << seed << "\n";
+				return 1;
+			}
+		}
+	}
+
+	//A full bucket of the transposition table must give up its shallowest value of the current search, and values of an
+	//earlier search must make way for new ones without counting as overwrites
+	{
+		transpositionTable oneBucket(4);
+		transpositionStats bucketStats;
+		double value = 0;
+		for (int depth = 1; depth <= 4; depth++)
+		{
+			oneBucket.store(std::uint64_t(depth) << 40, depth, depth, bucketStats);
+		}
+		oneBucket.store(std::uint64_t(5) << 40, 5, 0, bucketStats);
+		bool kept = !oneBucket.lookup(std::uint64_t(1) << 40, value, bucketStats) && oneBucket.lookup(std::uint64_t(4) << 40, value, bucketStats) && value == 4;
+		kept = kept && oneBucket.lookup(std::uint64_t(5) << 40, value, bucketStats) && value == 5 && bucketStats.overwrites == 1;
+		oneBucket.newSearch();
+		kept = kept && !oneBucket.lookup(std::uint64_t(4) << 40, value, bucketStats);
+		for (int key = 6; key <= 9; key++)
+		{
+			oneBucket.store(std::uint64_t(key) << 40, key, 1, bucketStats);
+		}
+		for (int key = 6; key <= 9; key++)
+		{
+			kept = kept && oneBucket.lookup(std::uint64_t(key) << 40, value, bucketStats) && value == key;
+		}
+		if (!kept || bucketStats.overwrites != 1)
+		{
+			std::cerr << "The transposition table replaced the wrong slots, with " << bucketStats.overwrites << " overwrites\n";
+			return 1;
+		}
+	}
+
+	//A tetromino spawning into the stack loses the game at once, even with the middle cell of the top row left empty,
+	//whether it comes after a lock or out of the hold slot; the AI must count such a lock as a loss as well
+	{
+		board walled;
+		for (int y = 0; y < numRows; y++)
+		{
+			walled.fillCell(numColumns / 2 - 1, y, 1);
+			walled.fillCell(numColumns / 2 + 1, y, 1);
+		}
+		const std::uint8_t spawnInputs[] = {inputHardDrop, inputHold};
+		for (int i = 0; i < 2; i++)
+		{
+			gameState walledGame(41);
+			input toWall;
+			toWall.flags = inputLeft;
+			toWall.repeats = numColumns;
+			walledGame.applyInput(toWall);
+			walledGame.loadBoard(walled);
+			stepResult result = walledGame.step(input{spawnInputs[i]});
+			if (!walledGame.isGameOver() || !result.lost)
+			{
+				std::cerr << "A tetromino spawned into the stack after a " << (i == 0 ? "lock" : "hold") << " without ending the game\n";
+				return 1;
+			}
+		}
+
+		board aiField = walled;
+		placement leftWall = {1, std::int8_t(numRows - 2), 0};
+		if (placePiece(aiField, 2, leftWall, 0) >= 0)
+		{
+			std::cerr << "The AI scored a lock whose next tetromino spawns into the stack as playable\n";
+			return 1;
+		}
+	}
+
+	//Clearing every full row in one pass must leave the same board as clearing them one at a time
+	for (int b = 0; b < stacks.size(); b++)
+	{
+		board singlePass = stacks[b].field;
+		board perRow = stacks[b].field;
+		singlePass.clearFullRows();
+		for (int y = 0; y < numRows; y++)
+		{
+			if (perRow.isRowComplete(y))
+			{
+				perRow.clearRow(y);
+			}
+		}
+
+		bool same = singlePass.returnHash() == perRow.returnHash() && singlePass.returnHash() == singlePass.computeHash();
+		for (int y = 0; y < numRows; y++)
+		{
+			for (int x = 0; x < numColumns; x++)
+			{
+				same = same && singlePass.returnColor(x, y) == perRow.returnColor(x, y) && singlePass.isOccupied(x, y) == perRow.isOccupied(x, y);
+			}
+		}
+		if (!same)
+		{
+			std::cerr << "clearFullRows disagrees with clearRow on " << stacks[b].name << "\n";
+			return 1;
+		}
+	}
+
+	//A held side key moves once, then again after the DAS and every ARR, counted from the press whatever the step length,
+	//a tap inside one step still moves once, and with no ARR the held key reaches the wall within a step
+	const std::int64_t millisecond = 1000000;
+	handlingSettings handling;
+	handling.das = std::chrono::milliseconds(133);
+	handling.arr = std::chrono::milliseconds(33);
+	std::vector<keyEvent> held = {{5 * millisecond, keyLeft, true}, {300 * millisecond, keyLeft, false}};
+	std::vector<keyEvent> tap = {{2 * millisecond, keyRight, true}, {5 * millisecond, keyRight, false}};
+	int maxRepeats = 0;
+	std::int64_t tickMoves = handledMoves(handling, held, 1000000000 / ticksPerSecond, 400 * millisecond, maxRepeats);
+	std::int64_t fineMoves = handledMoves(handling, held, millisecond, 400 * millisecond, maxRepeats);
+	std::int64_t tapMoves = handledMoves(handling, tap, 1000000000 / ticksPerSecond, 100 * millisecond, maxRepeats);
+	handling.arr = std::chrono::nanoseconds(0);
+	handledMoves(handling, held, 1000000000 / ticksPerSecond, 200 * millisecond, maxRepeats);
+	if (tickMoves != -6 || fineMoves != -6 || tapMoves != 1 || maxRepeats != numColumns - 1)
+	{
+		std::cerr << "DAS and ARR handling moved " << tickMoves << " and " << fineMoves << " for a held key, " << tapMoves << " for a tap and repeated " << maxRepeats << " with no ARR\n";
+		return 1;
+	}
+
+	//Histogram percentiles must be within the 1/16 bucket error of the exact ones, and a merge must count both sides
+	latencyHistogram lowHalf, highHalf;
+	for (std::uint64_t value = 1; value <= 1000000; value++)
+	{
+		(value <= 500000 ? lowHalf : highHalf).record(value * 37);
+	}
+	lowHalf.merge(highHalf);
+	const double fractions[] = {0.01, 0.5, 0.9, 0.99, 0.999};
+	for (int i = 0; i < 5; i++)
+	{
+		double exact = fractions[i] * 1000000 * 37;
+		double reported = lowHalf.returnPercentile(fractions[i]);
+		if (lowHalf.returnCount() != 1000000 || reported < exact * (1 - 1.0 / 16) || reported > exact * (1 + 1.0 / 16))
+		{
+			std::cerr << "Histogram reports " << reported << " for the " << fractions[i] << " percentile of " << exact << "\n";
+			return 1;
+		}
+	}
+
+	//A canvas redrawing only the dirty cells of a view must show what a view built from scratch shows, every step
+	{
+		gameState viewGame(21);
+		inputPolicy viewPolicy(policyRandom, 21);
+		boardView incremental;
+		std::uint8_t drawn[numRows][numColumns] = {};
+		for (int i = 0; i < 20000; i++)
+		{
+			stepResult result = viewGame.step(viewPolicy.nextInput(viewGame));
+			if (viewGame.isGameOver())
+			{
+				viewGame.restart();
+			}
+			incremental.update(viewGame, result.locked);
+			for (int y = 0; y < numRows; y++)
+			{
+				for (std::uint32_t mask = incremental.returnDirtyRow(y); mask != 0; mask &= mask - 1)
+				{
+					int x = lowestSetBit(mask);
+					drawn[y][x] = incremental.returnCell(x, y);
+				}
+			}
+			incremental.clearDirty();
+
+			boardView scratch;
+			scratch.update(viewGame, true);
+			for (int y = 0; y < numRows; y++)
+			{
+				for (int x = 0; x < numColumns; x++)
+				{
+					if (shownColor(drawn[y][x]) != shownColor(scratch.returnCell(x, y)) || isGhostCell(drawn[y][x]) != isGhostCell(scratch.returnCell(x, y)))
+					{
+						std::cerr << "Dirty cell tracking missed (" << x << ", " << y << ") at step " << i << "\n";
+						return 1;
+					}
+				}
+			}
+		}
+	}
+
+	//A client applying the board updates of a game must end up with what the server's baseline holds after every step,
+	//and its rebuilt board must hash like the game's
+	{
+		gameState sentGame(23);
+		inputPolicy sentPolicy(policyRandom, 23);
+		playerView baseline;
+		playerView received[1];
+		std::vector<std::uint8_t> message;
+		for (int i = 0; i < 20000; i++)
+		{
+			sentGame.step(sentPolicy.nextInput(sentGame));
+			if (sentGame.isGameOver())
+			{
+				sentGame.restart();
+			}
+
+			message.clear();
+			if (writeUpdate(message, 0, i + 1, i, sentGame, baseline))
+			{
+				byteReader in(message.data(), message.size());
+				in.readByte();
+				readUpdate(in, received, 1);
+			}
+			const playerView &view = received[0];
+			bool same = std::equal(&view.rows[0][0], &view.rows[0][0] + sizeof(view.rows), &baseline.rows[0][0]) && view.shape == baseline.shape && view.rotation == baseline.rotation;
+			same = same && view.x == baseline.x && view.y == baseline.y && view.held == baseline.held && view.score == baseline.score && view.pendingGarbage == baseline.pendingGarbage;
+			if (!same || view.gameOver != sentGame.isGameOver() || view.toBoard().returnHash() != sentGame.returnBoard().returnHash())
+			{
+				std::cerr << "A board update left the client's view different from the game at step " << i << "\n";
+				return 1;
+			}
+		}
+	}
+
+	//Garbage pushed in with row and column shifts must leave the board a block list gets to one block at a time,
+	//with its hash and column masks right, and must report blocks pushed off the top
+	for (int b = 0; b < stacks.size(); b++)
+	{
+		for (int count = 1; count <= 4; count++)
+		{
+			int hole = (b * 3 + count) % numColumns;
+			board shifted = stacks[b].field;
+			bool toppedOut = shifted.addGarbageRows(count, hole);
+			board expected;
+			std::vector<block> blocks = legacy::addGarbageRows(stacks[b].blockList, count, hole);
+			for (int i = 0; i < blocks.size(); i++)
+			{
+				expected.fillCell(blocks[i].returnPosition().x, blocks[i].returnPosition().y, blocks[i].returnColor());
+			}
+
+			bool same = shifted.returnHash() == shifted.computeHash() && shifted.returnHash() == expected.returnHash();
+			same = same && toppedOut == (blocks.size() < stacks[b].blockList.size() + count * (numColumns - 1));
+			for (int y = 0; y < numRows; y++)
+			{
+				for (int x = 0; x < numColumns; x++)
+				{
+					same = same && shifted.returnColor(x, y) == expected.returnColor(x, y);
+					same = same && ((shifted.returnColumn(x) >> y) & 1) == ((shifted.returnRow(y) >> x) & 1);
+				}
+			}
+			if (!same)
+			{
+				std::cerr << "addGarbageRows disagrees with moving blocks for " << count << " rows on " << stacks[b].name << "\n";
+				return 1;
+			}
+		}
+	}
+
+	//Garbage as tall as the board, on one whose column masks are exactly that tall, replaces the stack, and hole columns
+	//past either wall wrap around
+	{
+		basicBoard<numColumns, 32> tall;
+		tall.fillCell(0, 31, 1);
+		bool toppedOut = tall.addGarbageRows(32, numColumns + 3);
+		bool replaced = toppedOut && tall.returnHash() == tall.computeHash();
+		for (int x = 0; x < numColumns; x++)
+		{
+			replaced = replaced && tall.returnColumn(x) == (x == 3 ? 0 : 0xFFFFFFFFu);
+		}
+		board wrapped;
+		wrapped.addGarbageRows(1, -1);
+		replaced = replaced && !wrapped.isOccupied(numColumns - 1, numRows - 1) && wrapped.isOccupied(0, numRows - 1);
+		if (!replaced)
+		{
+			std::cerr << "addGarbageRows mishandled a full board of garbage or a hole past the wall\n";
+			return 1;
+		}
+	}
+
+	//The attack table: T-spins over plain clears, back-to-back adding one and combos adding more the longer they run
+	const int attackCases[][5] = {{1, tSpinNone, 0, 0, 0}, {4, tSpinNone, 0, 0, 4}, {4, tSpinNone, 1, 0, 5}, {2, tSpinFull, 0, 0, 4},
+		{3, tSpinFull, 1, 0, 7}, {2, tSpinMini, 0, 0, 1}, {1, tSpinNone, 0, 2, 1}, {2, tSpinNone, 0, 11, 6}, {0, tSpinFull, 1, 3, 0}};
+	for (const int *c : attackCases)
+	{
+		if (attackForClear(c[0], tSpinType(c[1]), c[2], c[3]) != c[4])
+		{
+			std::cerr << "A clear of " << c[0] << " lines with T-spin " << c[1] << " attacks for " << attackForClear(c[0], tSpinType(c[1]), c[2], c[3]) << " instead of " << c[4] << "\n";
+			return 1;
+		}
+	}
+
+	//A game loaded partway through, with garbage queued, a combo running and back-to-back set, must go on exactly like the
+	//one it was saved from
+	{
+		gameState savedGame(29);
+		inputPolicy savedPolicy(policyAi, 29);
+		for (int i = 0; i < 3000; i++)
+		{
+			savedGame.step(savedPolicy.nextInput(savedGame));
+			if (i % 200 == 0)
+			{
+				savedGame.receiveGarbage(1 + i / 200 % 2, i / 200 % numColumns);
+			}
+			if (savedGame.isGameOver())
+			{
+				savedGame.restart();
+			}
+		}
+		savedGame.receiveGarbage(2, 3);
+
+		std::vector<std::uint8_t> saved;
+		byteWriter out(saved);
+		savedGame.save(out);
+		gameState loadedGame(0);
+		byteReader in(saved.data(), saved.size());
+		loadedGame.load(in);
+		bool same = loadedGame.returnPendingGarbage() == savedGame.returnPendingGarbage();
+		for (int i = 0; i < 5000 && same; i++)
+		{
+			input next = savedPolicy.nextInput(savedGame);
+			stepResult a = savedGame.step(next);
+			stepResult b = loadedGame.step(next);
+			same = a.attack == b.attack && a.combo == b.combo && a.garbageAdded == b.garbageAdded && savedGame.returnBoard().returnHash() == loadedGame.returnBoard().returnHash();
+			if (savedGame.isGameOver())
+			{
+				savedGame.restart();
+				loadedGame.restart();
+			}
+		}
+		if (!same)
+		{
+			std::cerr << "A game loaded with garbage queued played differently from the one saved\n";
+			return 1;
+		}
+	}
+
+	//A game stepped on predicted input and corrected through rollback once the real input arrives 12 ticks late must end up
+	//exactly where the game stepped with the real input straight away does
+	{
+		gameState actual(31);
+		gameState predicted(31);
+		rollbackRing<gameState, 16> ring;
+		inputPolicy actualPolicy(policyAi, 31);
+		std::vector<input> inputs;
+		bool same = ring.correct(predicted, 0, input()) == -1;
+		for (int i = 0; i < 5000; i++)
+		{
+			inputs.push_back(actualPolicy.nextInput(actual));
+			actual.step(inputs.back());
+			//The remote input is not there yet, so no keys are predicted for it
+			ring.advance(predicted, input());
+			if (i >= 12)
+			{
+				same = same && ring.correct(predicted, i - 12, inputs[i - 12]) == 13;
+			}
+		}
+		for (int i = inputs.size() - 12; i < inputs.size(); i++)
+		{
+			same = same && ring.correct(predicted, i, inputs[i]) == inputs.size() - i && ring.returnInput(i).flags == inputs[i].flags;
+		}
+
+		std::vector<std::uint8_t> predictedBytes, actualBytes;
+		byteWriter predictedOut(predictedBytes), actualOut(actualBytes);
+		predicted.save(predictedOut);
+		actual.save(actualOut);
+		if (!same || predictedBytes != actualBytes || actual.returnPiecesPlaced() < 100)
+		{
+			std::cerr << "A game corrected through rollback ended up different from the one stepped with the real input\n";
+			return 1;
+		}
+	}
+
+	//Every board size must keep its hash and column masks right and clear lines; the narrow ones clear some in this many steps
+	for (const boardSize &size : boardSizes)
+	{
+		int lines = withBoardSize(size, [](auto width, auto height)
+		{
+			return checkBoardSize<width(), height()>(200000);
+		});
+		if (lines < 0 || (size.width == numColumns && lines == 0))
+		{
+			std::cerr << "The " << size.width << "x" << size.height << " board cleared " << lines << " lines\n";
+			return 1;
+		}
+	}
+
+	//Every randomizer must deal the same shapes from the same seed, also after a save and load partway through,
+	//and the bag randomizer must deal each shape once in every group of seven
+	for (int type = 0; type < numRandomizers; type++)
+	{
+		pieceRandomizer first(randomizerType(type), 11);
+		pieceRandomizer second(randomizerType(type), 11);
+		int counts[numShapes] = {};
+		bool same = true;
+		bool dealtEvenly = true;
+		for (int i = 0; i < 7000; i++)
+		{
+			if (i == 3500)
+			{
+				std::vector<std::uint8_t> saved;
+				byteWriter out(saved);
+				first.save(out);
+				byteReader in(saved.data(), saved.size());
+				second = pieceRandomizer();
+				second.load(in);
+			}
+
+			int shape = first.next();
+			same = same && shape == second.next();
+			counts[shape]++;
+			if (type == randomizerBag && i % numShapes == numShapes - 1)
+			{
+				dealtEvenly = dealtEvenly && std::count(counts, counts + numShapes, i / numShapes + 1) == numShapes;
+			}
+		}
+		if (!same || !dealtEvenly)
+		{
+			std::cerr << "The " << randomizerName(randomizerType(type)) << " randomizer " << (same ? "dealt a bag unevenly" : "is not deterministic") << "\n";
+			return 1;
+		}
+	}
+
+	//Once a game is running, its steps must not touch the heap, whichever policy plays it
+	const policyType steadyPolicies[] = {policyRandom, policyAi};
+	for (int p = 0; p < 2; p++)
+	{
+		gameState steadyGame(3);
+		inputPolicy steadyPolicy(steadyPolicies[p], 3);
+		for (int i = 0; i < 1000; i++)
+		{
+			steadyGame.step(steadyPolicy.nextInput(steadyGame));
+		}
+
+		std::uint64_t allocationsBefore = allocationCount.load(std::memory_order_relaxed);
+		for (int i = 0; i < 50000; i++)
+		{
+			steadyGame.step(steadyPolicy.nextInput(steadyGame));
+			if (steadyGame.isGameOver())
+			{
+				steadyGame.restart();
+			}
+		}
+		std::uint64_t allocations = allocationCount.load(std::memory_order_relaxed) - allocationsBefore;
+		if (allocations != 0)
+		{
+			std::cerr << allocations << " heap allocations in 50000 steady state steps with policy " << p << "\n";
+			return 1;
+		}
+	}
+
+	std::cout << "move generator uses " << returnMoveGenInstructionSet() << "\n";
+	std::cout << std::left << std::setw(40) << "benchmark" << std::right << std::setw(14) << "ns/op" << std::setw(14) << "allocs/op" << "\n";
+
+	//Stores and lookups of keys spread over a table too small to hold them all
+	transpositionTable table(1 << 16);
+	transpositionStats tableStats;
+	runBenchmark(filter, "table", "store", "lockfree", [&](std::uint64_t i)
+	{
+		table.store(mixBits(i & 0x3FFFF), double(i), int(i & 3), tableStats);
+	});
+	runBenchmark(filter, "table", "lookup", "lockfree", [&](std::uint64_t i)
+	{
+		double value = 0;
+		doNotOptimize(table.lookup(mixBits(i & 0x3FFFF), value, tableStats));
+	});
+	if (tableStats.probes > 0)
+	{
+		std::cout << "table hit rate " << tableStats.returnHitRate() << " with a quarter of the keys fitting\n";
+	}
+
+	//Passing key events through the queue between the window and the simulation, and turning them into a step input
+	keyEventQueue eventQueue;
+	runBenchmark(filter, "keyQueue", "push-pop", "spsc", [&](std::uint64_t i)
+	{
+		keyEvent event = {std::int64_t(i), std::uint8_t(i & 7), bool(i & 1)};
+		eventQueue.push(event);
+		eventQueue.pop(event);
+		doNotOptimize(event);
+	});
+	inputHandler benchHandler(handling);
+	runBenchmark(filter, "handler", "nextStep", "das-arr", [&](std::uint64_t i)
+	{
+		std::int64_t time = std::int64_t(i) * millisecond;
+		eventQueue.push({time, std::uint8_t(i & 1), bool((i >> 1) & 1)});
+		doNotOptimize(benchHandler.nextStep(eventQueue, time + millisecond));
+	});
+
+	//Recording a duration, timing a scope into a profiler and counting an event
+	latencyHistogram benchHistogram;
+	runBenchmark(filter, "instrument", "record", "histogram", [&](std::uint64_t i)
+	{
+		benchHistogram.record(mixBits(i) & 0xFFFFFF);
+	});
+	frameProfiler benchProfiler;
+	activeProfiler = &benchProfiler;
+	runBenchmark(filter, "instrument", "scopedTimer", "profiler", [&](std::uint64_t)
+	{
+		scopedTimer timer(phaseSimulation);
+	});
+	activeProfiler = nullptr;
+	runBenchmark(filter, "instrument", "add", "counterBank", [&](std::uint64_t)
+	{
+		globalCounters.add(counterSteps);
+	});
+
+	//Writing the board update of a step of a random game, which is mostly the moved active tetromino
+	gameState updateGame(6);
+	inputPolicy updatePolicy(policyRandom, 6);
+	playerView updateBaseline;
+	std::vector<std::uint8_t> updateMessage;
+	std::uint64_t updateBytes = 0;
+	std::uint64_t updateCount = 0;
+	std::uint64_t updateSteps = 0;
+	runBenchmark(filter, "update", "write", "delta", [&](std::uint64_t i)
+	{
+		updateGame.step(updatePolicy.nextInput(updateGame));
+		if (updateGame.isGameOver())
+		{
+			updateGame.restart();
+		}
+		updateMessage.clear();
+		updateSteps++;
+		updateCount += writeUpdate(updateMessage, 0, i, i, updateGame, updateBaseline);
+		updateBytes += updateMessage.size();
+	});
+	if (updateCount > 0)
+	{
+		std::cout << "board updates average " << double(updateBytes) / updateCount << " bytes and are sent on " << 100.0 * updateCount / updateSteps << "% of steps\n";
+	}
+
+	//Bringing a board view up to date after a step that moved the active tetromino, and after one that locked it
+	std::cout << "board view is " << sizeof(boardView) << " bytes\n";
+	gameState benchViewGame(4);
+	boardView benchView;
+	runBenchmark(filter, "boardView", "update", "moved", [&](std::uint64_t i)
+	{
+		benchViewGame.applyInput(input{std::uint8_t(i & 1 ? inputLeft : inputRight)});
+		benchView.update(benchViewGame, false);
+		benchView.clearDirty();
+	});
+	runBenchmark(filter, "boardView", "update", "locked", [&](std::uint64_t)
+	{
+		benchView.update(benchViewGame, true);
+		benchView.clearDirty();
+	});
+
+	//Rolling a game back 12 ticks and stepping it forward again, as a late remote input does, and one step that keeps a
+	//snapshot; both copy the whole game, which is this many bytes
+	std::cout << "game state is " << sizeof(gameState) << " bytes\n";
+	gameState rollbackGame(5);
+	rollbackRing<gameState, 16> rollbackHistory;
+	inputPolicy rollbackPolicy(policyRandom, 5);
+	for (int i = 0; i < 64; i++)
+	{
+		rollbackHistory.advance(rollbackGame, rollbackPolicy.nextBlindInput());
+	}
+	runBenchmark(filter, "rollback", "resimulate", "12-ticks", [&](std::uint64_t i)
+	{
+		rollbackHistory.correct(rollbackGame, rollbackHistory.returnTick() - 12, input{std::uint8_t(i & 1 ? inputLeft : inputRight)});
+		doNotOptimize(rollbackGame);
+	});
+	runBenchmark(filter, "rollback", "advance", "snapshot", [&](std::uint64_t)
+	{
+		rollbackHistory.advance(rollbackGame, rollbackPolicy.nextBlindInput());
+		if (rollbackGame.isGameOver())
+		{
+			rollbackGame.restart();
+		}
+	});
+
+	//One step of a game played with random inputs on every board size, from the same seed
+	for (const boardSize &size : boardSizes)
+	{
+		withBoardSize(size, [&](auto width, auto height)
+		{
+			basicGameState<width(), height()> sizedGame(5);
+			inputPolicy sizedPolicy(policyRandom, 5);
+			runBenchmark(filter, "step", std::to_string(width()) + "x" + std::to_string(height()), "random", [&](std::uint64_t)
+			{
+				doNotOptimize(sizedGame.step(sizedPolicy.nextBlindInput()));
+				if (sizedGame.isGameOver())
+				{
+					sizedGame.restart();
+				}
+			});
+		});
+	}
+
+	//Dealing the next shape with each randomizer
+	for (int type = 0; type < numRandomizers; type++)
+	{
+		pieceRandomizer randomizer(randomizerType(type), 1);
+		runBenchmark(filter, "randomizer", "next", randomizerName(randomizerType(type)), [&](std::uint64_t)
+		{
+			doNotOptimize(randomizer.next());
+		});
+	}
+
+	for (int b = 0; b < stacks.size(); b++)
+	{
+		const benchBoard &stack = stacks[b];
+
+		//The T piece at its spawn position above the stack
+		tetromino activeTet(2);
+		std::vector<legacy::tetromino> legacyList(1, legacy::tetromino(2));
+
+		runBenchmark(filter, "canMove", "bitboard", stack.name, [&](std::uint64_t i)
+		{
+			doNotOptimize(canMove(activeTet, stack.field, 1 + (i & 1) * 2));
+		});
+		runBenchmark(filter, "canMove", "legacy", stack.name, [&](std::uint64_t i)
+		{
+			doNotOptimize(legacy::canMove(legacyList, stack.blockList, 1 + (i & 1) * 2));
+		});
+
+		runBenchmark(filter, "canRotate", "bitboard", stack.name, [&](std::uint64_t)
+		{
+			doNotOptimize(canRotate(activeTet, stack.field, 1));
+		});
+		runBenchmark(filter, "canRotate", "legacy", stack.name, [&](std::uint64_t)
+		{
+			doNotOptimize(legacy::canRotate(legacyList, stack.blockList, 1));
+		});
+
+		runBenchmark(filter, "isRowComplete", "bitboard", stack.name, [&](std::uint64_t i)
+		{
+			doNotOptimize(stack.field.isRowComplete(i % numRows));
+		});
+		runBenchmark(filter, "isRowComplete", "legacy", stack.name, [&](std::uint64_t i)
+		{
+			doNotOptimize(legacy::isRowComplete(stack.blockList, i % numRows));
+		});
+
+		//Both clear a copy of the stack; the legacy version copies its vector on every call anyway
+		runBenchmark(filter, "clearRow", "bitboard", stack.name, [&](std::uint64_t i)
+		{
+			board field = stack.field;
+			field.clearRow(numRows - 1 - i % 4);
+			doNotOptimize(field);
+		});
+		runBenchmark(filter, "clearRow", "legacy", stack.name, [&](std::uint64_t i)
+		{
+			std::vector<block> cleared = legacy::clearRow(stack.blockList, numRows - 1 - i % 4);
+			doNotOptimize(cleared);
+		});
+
+		//Garbage rising under a copy of the stack, by shifting masks against moving every block
+		runBenchmark(filter, "garbage", "rowShift", stack.name, [&](std::uint64_t i)
+		{
+			board field = stack.field;
+			doNotOptimize(field.addGarbageRows(1 + i % 4, i % numColumns));
+			doNotOptimize(field);
+		});
+		runBenchmark(filter, "garbage", "legacy", stack.name, [&](std::uint64_t i)
+		{
+			std::vector<block> raised = legacy::addGarbageRows(stack.blockList, 1 + i % 4, i % numColumns);
+			doNotOptimize(raised);
+		});
+
+		//Every full row at once against one clearRow call per full row, as the step used to do
+		runBenchmark(filter, "clearFullRows", "single-pass", stack.name, [&](std::uint64_t)
+		{
+			board field = stack.field;
+			field.clearFullRows();
+			doNotOptimize(field);
+		});
+		runBenchmark(filter, "clearFullRows", "per-row", stack.name, [&](std::uint64_t)
+		{
+			board field = stack.field;
+			for (int y = 0; y < numRows; y++)
+			{
+				if (field.isRowComplete(y))
+				{
+					field.clearRow(y);
+				}
+			}
+			doNotOptimize(field);
+		});
+
+		runBenchmark(filter, "decompose", "bitboard", stack.name, [&](std::uint64_t)
+		{
+			board field = stack.field;
+			activeTet.decompose(field);
+			doNotOptimize(field);
+		});
+		runBenchmark(filter, "decompose", "legacy", stack.name, [&](std::uint64_t)
+		{
+			std::vector<block> locked = legacyList[0].decompose(stack.blockList);
+			doNotOptimize(locked);
+		});
+
+		//Every placement of each shape in turn from its spawn position
+		static placementList moves;
+		runBenchmark(filter, "placements", "bitboard", stack.name, [&](std::uint64_t i)
+		{
+			findPlacements(stack.field, tetromino(i % numShapes), moves);
+			doNotOptimize(moves.returnCount());
+		});
+		runBenchmark(filter, "placements", "stepwise", stack.name, [&](std::uint64_t i)
+		{
+			doNotOptimize(stepwisePlacements(stack.field, tetromino(i % numShapes)).size());
+		});
+
+		//Where the T piece lands from the spawn row, read from the column masks or found a row at a time
+		runBenchmark(filter, "dropDistance", "columns", stack.name, [&](std::uint64_t)
+		{
+			doNotOptimize(dropDistance(activeTet, stack.field));
+		});
+		runBenchmark(filter, "dropDistance", "stepwise", stack.name, [&](std::uint64_t)
+		{
+			doNotOptimize(stepwiseDrop(activeTet, stack.field));
+		});
+
+		//Hashing every row against reading the hash kept up to date by fillCell and clearRow
+		runBenchmark(filter, "hash", "incremental", stack.name, [&](std::uint64_t)
+		{
+			doNotOptimize(stack.field.returnHash());
+		});
+		runBenchmark(filter, "hash", "rescan", stack.name, [&](std::uint64_t)
+		{
+			doNotOptimize(stack.field.computeHash());
+		});
+
+		//One tick of the game logic from a fresh copy of the same state each time
+		//Gravity acts on every step so both sides do the same work; copying the legacy state allocates,
+		//as did the old loop, so its allocations include the copy
+		gameRules everyTick;
+		std::fill(everyTick.gravity.ticksPerRow, everyTick.gravity.ticksPerRow + numLevels, 1);
+		gameState baseGame(1, everyTick);
+		baseGame.loadBoard(stack.field);
+		runBenchmark(filter, "tick", "bitboard", stack.name, [&](std::uint64_t)
+		{
+			gameState game = baseGame;
+			doNotOptimize(game.step());
+		});
+		legacy::loopState baseLoop;
+		baseLoop.tetrominoList = legacyList;
+		baseLoop.decomposedTetrominos = stack.blockList;
+		runBenchmark(filter, "tick", "legacy", stack.name, [&](std::uint64_t)
+		{
+			legacy::loopState loop = baseLoop;
+			legacy::tick(loop, 2);
+			doNotOptimize(loop.score);
+		});
+	}
+}
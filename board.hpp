@@ -0,0 +1,459 @@
+#ifndef BOARD_HPP
+#define BOARD_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+//Size of the standard board, which the window, the move generator and the AI play on
+constexpr int numColumns = 10;
+constexpr int numRows = 20;
+//Color index of garbage rows pushed in from below, after the colors of the seven shapes
+constexpr std::uint8_t garbageColor = 8;
+//Rows above the top a piece can spawn, move and turn in; anything higher is treated like a wall
+constexpr int hiddenRows = 4;
+
+//Returns the index of the lowest set bit of a non-zero mask
+inline int lowestSetBit(std::uint32_t mask)
+{
+#if defined(__GNUC__) || defined(__clang__)
+	return __builtin_ctz(mask);
+#else
+	int index = 0;
+	while (!(mask & 1))
+	{
+		mask >>= 1;
+		index++;
+	}
+	return index;
+#endif
+}
+
+//Returns the index of the lowest set bit of a non-zero 64 bit mask
+inline int lowestSetBit(std::uint64_t mask)
+{
+#if defined(__GNUC__) || defined(__clang__)
+	return __builtin_ctzll(mask);
+#else
+	int index = 0;
+	while (!(mask & 1))
+	{
+		mask >>= 1;
+		index++;
+	}
+	return index;
+#endif
+}
+
+//Smaller masks go through the 32 bit scan
+inline int lowestSetBit(std::uint16_t mask)
+{
+	return lowestSetBit(std::uint32_t(mask));
+}
+
+//Returns the number of set bits of a mask
+inline int countSetBits(std::uint32_t mask)
+{
+#if defined(__GNUC__) || defined(__clang__)
+	return __builtin_popcount(mask);
+#else
+	int count = 0;
+	while (mask)
+	{
+		mask &= mask - 1;
+		count++;
+	}
+	return count;
+#endif
+}
+
+//splitmix64 finalizer, used to fill the hashing table at compile time
+constexpr std::uint64_t mixBits(std::uint64_t z)
+{
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+	return z ^ (z >> 31);
+}
+
+//Smallest unsigned type with at least the given number of bits, up to 64
+template <int bits>
+using maskFor = typename std::conditional<bits <= 16, std::uint16_t, typename std::conditional<bits <= 32, std::uint32_t, std::uint64_t>::type>::type;
+
+//Returns a mask with the low count bits set, for counts up to the width of the mask
+template <class mask>
+constexpr mask lowBits(int count)
+{
+	return count >= int(8 * sizeof(mask)) ? mask(~mask(0)) : mask((mask(1) << count) - 1);
+}
+
+/* Zobrist keys of the filled cells of a board of the given size, XORed together a row at a time
+Each row mask is split into chunks of at most 8 bits, and every possible chunk has the XOR of the keys of its cells
+precomputed, so the hash of any row is a lookup per chunk; the standard board has two chunks of 5 bits */
+template <int width, int height>
+struct zobristTable
+{
+	static constexpr int numChunks = (width + 7) / 8;
+	static constexpr int chunkBits = (width + numChunks - 1) / numChunks;
+
+	std::uint64_t chunks[height][numChunks][1 << chunkBits];
+};
+
+template <int width, int height>
+constexpr zobristTable<width, height> makeZobristTable()
+{
+	typedef zobristTable<width, height> table;
+	table keys{};
+	for (int y = 0; y < height; y++)
+	{
+		for (int chunk = 0; chunk < table::numChunks; chunk++)
+		{
+			for (int mask = 0; mask < (1 << table::chunkBits); mask++)
+			{
+				for (int bit = 0; bit < table::chunkBits; bit++)
+				{
+					int x = chunk * table::chunkBits + bit;
+					if (((mask >> bit) & 1) && x < width)
+					{
+						keys.chunks[y][chunk][mask] ^= mixBits(0x9E3779B97F4A7C15ull * std::uint64_t(y * width + x + 1));
+					}
+				}
+			}
+		}
+	}
+
+	return keys;
+}
+
+template <int width, int height>
+inline constexpr zobristTable<width, height> zobristKeys = makeZobristTable<width, height>();
+
+//Returns the XOR of the Zobrist keys of the filled cells of a row
+template <int width, int height>
+inline std::uint64_t zobristRow(int y, std::uint64_t mask)
+{
+	typedef zobristTable<width, height> table;
+	std::uint64_t key = 0;
+	for (int chunk = 0; chunk < table::numChunks; chunk++)
+	{
+		key ^= zobristKeys<width, height>.chunks[y][chunk][(mask >> (chunk * table::chunkBits)) & ((1u << table::chunkBits) - 1)];
+	}
+	return key;
+}
+
+//Playfield holding every locked block as one bit mask per row
+//Bit x of a row mask is set when the cell in column x of that row is filled
+//The same cells are also kept as one bit mask per column, bit y set when row y of that column is filled,
+//so that how far a piece can fall is a bit scan per column it covers
+//The size is fixed at compile time and picks the narrowest row and column mask types that hold it,
+//so every size gets its own kernels with no size checks in them
+template <int setWidth, int setHeight>
+class basicBoard
+{
+	static_assert(setWidth >= 4 && setWidth <= 64, "Row masks are stored in at most 64 bits");
+	static_assert(setHeight >= 4 && setHeight <= 64, "Column masks are stored in at most 64 bits");
+
+	public:
+		static constexpr int width = setWidth;
+		static constexpr int height = setHeight;
+		typedef maskFor<width> rowMask;
+		typedef maskFor<height> columnMask;
+		static constexpr rowMask fullRow = lowBits<rowMask>(width);
+
+	private:
+		rowMask rows[height];
+		columnMask columns[width];
+		//Color plane parallel to the row masks, two 4-bit color indices per byte
+		//Index 0 is left for empty cells
+		std::uint8_t colors[height][(width + 1) / 2];
+		//Zobrist hash of the filled cells, kept up to date by every change; colors are not hashed
+		std::uint64_t hash;
+
+		void rebuildColumns();
+		static std::uint64_t hashRow(int y, rowMask mask);
+
+	public:
+		basicBoard();
+		void clear();
+
+		bool isOccupied(int x, int y) const;
+		bool collides(rowMask mask, int y) const;
+		rowMask returnRow(int y) const;
+		columnMask returnColumn(int x) const;
+		int returnColumnHeight(int x) const;
+		std::uint8_t returnColor(int x, int y) const;
+		std::uint64_t returnHash() const;
+		std::uint64_t computeHash() const;
+
+		void fillCell(int x, int y, std::uint8_t color);
+		bool isRowComplete(int row) const;
+		void clearRow(int row);
+		int clearFullRows();
+		bool addGarbageRows(int count, int holeColumn);
+};
+
+//The board the standard game is played on
+typedef basicBoard<numColumns, numRows> board;
+
+//Constructor starting with an empty playfield
+template <int setWidth, int setHeight>
+inline basicBoard<setWidth, setHeight>::basicBoard()
+{
+	clear();
+}
+
+//Empties every row and color of the playfield
+template <int setWidth, int setHeight>
+inline void basicBoard<setWidth, setHeight>::clear()
+{
+	std::memset(rows, 0, sizeof(rows));
+	std::memset(columns, 0, sizeof(columns));
+	std::memset(colors, 0, sizeof(colors));
+	hash = 0;
+}
+
+//Returns whether the cell at (x, y) blocks a piece
+//The side walls, the floor and the space past the hidden rows count as occupied, the hidden rows above the top do not
+template <int setWidth, int setHeight>
+inline bool basicBoard<setWidth, setHeight>::isOccupied(int x, int y) const
+{
+	if (x < 0 || x >= width || y >= height || y < -hiddenRows)
+	{
+		return true;
+	}
+	if (y < 0)
+	{
+		return false;
+	}
+
+	return (rows[y] >> x) & 1;
+}
+
+//Returns whether a slice of a piece given as a row mask overlaps the filled cells of row y
+//Rows below the floor or above the hidden rows collide with any non-empty mask
+template <int setWidth, int setHeight>
+inline bool basicBoard<setWidth, setHeight>::collides(rowMask mask, int y) const
+{
+	if (y >= height || y < -hiddenRows)
+	{
+		return mask != 0;
+	}
+	if (y < 0)
+	{
+		return false;
+	}
+
+	return (rows[y] & mask) != 0;
+}
+
+//Returns the mask of filled cells of row y
+template <int setWidth, int setHeight>
+inline typename basicBoard<setWidth, setHeight>::rowMask basicBoard<setWidth, setHeight>::returnRow(int y) const
+{
+	return rows[y];
+}
+
+//Returns the mask of filled cells of column x, bit y for row y
+template <int setWidth, int setHeight>
+inline typename basicBoard<setWidth, setHeight>::columnMask basicBoard<setWidth, setHeight>::returnColumn(int x) const
+{
+	return columns[x];
+}
+
+//Returns the number of rows from the floor up to and including the highest filled cell of column x
+template <int setWidth, int setHeight>
+inline int basicBoard<setWidth, setHeight>::returnColumnHeight(int x) const
+{
+	return columns[x] ? height - lowestSetBit(columns[x]) : 0;
+}
+
+//Returns the color index of the cell at (x, y), 0 if it is empty
+template <int setWidth, int setHeight>
+inline std::uint8_t basicBoard<setWidth, setHeight>::returnColor(int x, int y) const
+{
+	return (colors[y][x >> 1] >> ((x & 1) * 4)) & 0xF;
+}
+
+//Returns the Zobrist hash of the filled cells
+template <int setWidth, int setHeight>
+inline std::uint64_t basicBoard<setWidth, setHeight>::returnHash() const
+{
+	return hash;
+}
+
+//Returns the Zobrist hash of the filled cells worked out from every row, which returnHash always equals
+template <int setWidth, int setHeight>
+inline std::uint64_t basicBoard<setWidth, setHeight>::computeHash() const
+{
+	std::uint64_t rowsHash = 0;
+	for (int y = 0; y < height; y++)
+	{
+		rowsHash ^= hashRow(y, rows[y]);
+	}
+	return rowsHash;
+}
+
+//Marks the cell at (x, y) as filled with the given color index
+//Cells outside of the playfield are ignored
+template <int setWidth, int setHeight>
+inline void basicBoard<setWidth, setHeight>::fillCell(int x, int y, std::uint8_t color)
+{
+	if (x < 0 || x >= width || y < 0 || y >= height)
+	{
+		return;
+	}
+
+	int shift = (x & 1) * 4;
+	if (!((rows[y] >> x) & 1))
+	{
+		hash ^= hashRow(y, rowMask(1) << x);
+	}
+	rows[y] |= rowMask(rowMask(1) << x);
+	columns[x] |= columnMask(columnMask(1) << y);
+	colors[y][x >> 1] = (colors[y][x >> 1] & ~(0xF << shift)) | ((color & 0xF) << shift);
+}
+
+//Returns whether or not the given row has been filled and is ready to clear
+template <int setWidth, int setHeight>
+inline bool basicBoard<setWidth, setHeight>::isRowComplete(int row) const
+{
+	return rows[row] == fullRow;
+}
+
+//Removes the given row and moves every row above it down by one
+//Only the rows that move are rehashed, two table lookups each, before and after moving
+template <int setWidth, int setHeight>
+inline void basicBoard<setWidth, setHeight>::clearRow(int row)
+{
+	for (int y = 0; y <= row; y++)
+	{
+		hash ^= hashRow(y, rows[y]);
+	}
+
+	std::memmove(&rows[1], &rows[0], row * sizeof(rows[0]));
+	std::memmove(&colors[1], &colors[0], row * sizeof(colors[0]));
+	rows[0] = 0;
+	std::memset(colors[0], 0, sizeof(colors[0]));
+
+	for (int y = 1; y <= row; y++)
+	{
+		hash ^= hashRow(y, rows[y]);
+	}
+	rebuildColumns();
+}
+
+//Removes every complete row in one pass from the bottom up, moving each remaining row straight to where it ends up
+//Returns the number of rows removed
+template <int setWidth, int setHeight>
+inline int basicBoard<setWidth, setHeight>::clearFullRows()
+{
+	//Rows below the lowest complete one stay where they are
+	int write = height - 1;
+	while (write >= 0 && rows[write] != fullRow)
+	{
+		write--;
+	}
+	if (write < 0)
+	{
+		return 0;
+	}
+
+	for (int read = write - 1; read >= 0; read--)
+	{
+		if (rows[read] == fullRow)
+		{
+			continue;
+		}
+
+		//Rows below write were all read already, so rows[write] still holds its own row until it is replaced here
+		if (write != read)
+		{
+			hash ^= hashRow(write, rows[write]) ^ hashRow(write, rows[read]);
+			rows[write] = rows[read];
+			std::memcpy(colors[write], colors[read], sizeof(colors[write]));
+		}
+		write--;
+	}
+
+	//The rows left at the top are empty
+	for (int y = 0; y <= write; y++)
+	{
+		hash ^= hashRow(y, rows[y]);
+		rows[y] = 0;
+		std::memset(colors[y], 0, sizeof(colors[y]));
+	}
+	rebuildColumns();
+
+	return write + 1;
+}
+
+//Returns the XOR of the Zobrist keys of the filled cells of a row of this size of board
+template <int setWidth, int setHeight>
+inline std::uint64_t basicBoard<setWidth, setHeight>::hashRow(int y, rowMask mask)
+{
+	return zobristRow<width, height>(y, mask);
+}
+
+//Pushes count garbage rows in from below, every cell filled but the one in holeColumn, moving the stack up
+//The row masks and colors move with one memmove each and every column mask with one shift
+//A hole column past either wall wraps around, and garbage as tall as the board replaces the whole stack
+//Returns true when filled cells were pushed off the top, which loses the game
+template <int setWidth, int setHeight>
+inline bool basicBoard<setWidth, setHeight>::addGarbageRows(int count, int holeColumn)
+{
+	if (count <= 0)
+	{
+		return false;
+	}
+	count = count < height ? count : height;
+	holeColumn = (holeColumn % width + width) % width;
+
+	bool toppedOut = false;
+	for (int y = 0; y < count; y++)
+	{
+		toppedOut = toppedOut || rows[y] != 0;
+	}
+
+	std::memmove(&rows[0], &rows[count], (height - count) * sizeof(rows[0]));
+	std::memmove(&colors[0], &colors[count], (height - count) * sizeof(colors[0]));
+	rowMask garbage = rowMask(fullRow & ~(rowMask(1) << holeColumn));
+	std::uint8_t garbageColors[sizeof(colors[0])];
+	for (int x = 0; x < width; x += 2)
+	{
+		garbageColors[x >> 1] = garbageColor | (x + 1 < width ? garbageColor << 4 : 0);
+	}
+	garbageColors[holeColumn >> 1] &= ~(0xF << ((holeColumn & 1) * 4));
+	for (int y = height - count; y < height; y++)
+	{
+		rows[y] = garbage;
+		std::memcpy(colors[y], garbageColors, sizeof(colors[y]));
+	}
+
+	//Bit y of a column mask is row y, so moving the stack up is a shift down, and the garbage rows fill the top bits
+	//A column mask can be exactly as wide as the board is tall, so a full board of garbage shifts nothing in
+	columnMask garbageBits = columnMask(lowBits<columnMask>(height) & ~lowBits<columnMask>(height - count));
+	for (int x = 0; x < width; x++)
+	{
+		columnMask kept = count < height ? columnMask(columns[x] >> count) : columnMask(0);
+		columns[x] = columnMask(kept | (x == holeColumn ? 0 : garbageBits));
+	}
+
+	//Every row moved, so the hash is worked out again
+	hash = computeHash();
+	return toppedOut;
+}
+
+//Works the column masks out again from the row masks after rows have moved, visiting only the filled cells
+template <int setWidth, int setHeight>
+inline void basicBoard<setWidth, setHeight>::rebuildColumns()
+{
+	std::memset(columns, 0, sizeof(columns));
+	for (int y = 0; y < height; y++)
+	{
+		for (rowMask mask = rows[y]; mask != 0; mask &= mask - 1)
+		{
+			columns[lowestSetBit(mask)] |= columnMask(columnMask(1) << y);
+		}
+	}
+}
+
+#endif
@@ -0,0 +1,82 @@
+#include <algorithm>
+#include "boardView.hpp"
+
+//Constructor starting from an empty board with nothing covering it, every cell dirty so that it is drawn once
+boardView::boardView() : shownActive(0), shownGhost(0)
+{
+	std::fill(cells, cells + numRows * numColumns, 0);
+	shownActive.setPlacement(0, -numRows, 0);
+	shownGhost = shownActive;
+	markAll();
+}
+
+//Sets or clears the cover of the cells a tetromino has on the board, marking them dirty
+//A cover of 0 clears the cells, otherwise they take the tetromino's color and the given flags
+void boardView::cover(const tetromino &piece, std::uint8_t flags)
+{
+	for (int i = 0; i < blocksPerPiece; i++)
+	{
+		position p = piece.returnBlock(i).returnPosition();
+		if (p.x > -1 && p.x < numColumns && p.y > -1 && p.y < numRows)
+		{
+			std::uint8_t &cell = cells[p.y * numColumns + p.x];
+			std::uint8_t covered = flags ? std::uint8_t(((piece.returnShape() + 1) << coverShift) | (flags & ghostFlag)) : 0;
+			cell = (cell & lockedMask) | covered;
+			dirtyRows[p.y] |= 1u << p.x;
+		}
+	}
+}
+
+//Brings the view up to date with a game, marking the cells that changed
+//Locked blocks are only compared when boardChanged says a tetromino may have locked since the last update
+void boardView::update(const gameState &game, bool boardChanged)
+{
+	if (boardChanged)
+	{
+		const board &field = game.returnBoard();
+		for (int y = 0; y < numRows; y++)
+		{
+			std::uint8_t *row = cells + y * numColumns;
+			for (int x = 0; x < numColumns; x++)
+			{
+				std::uint8_t locked = field.returnColor(x, y);
+				if ((row[x] & lockedMask) != locked)
+				{
+					row[x] = (row[x] & ~lockedMask) | locked;
+					dirtyRows[y] |= 1u << x;
+				}
+			}
+		}
+	}
+
+	const tetromino &active = game.returnActive();
+	tetromino ghost = game.returnGhost();
+	auto samePlacement = [](const tetromino &a, const tetromino &b)
+	{
+		return a.returnShape() == b.returnShape() && a.returnRotation() == b.returnRotation() && a.returnPosition().x == b.returnPosition().x && a.returnPosition().y == b.returnPosition().y;
+	};
+	if (samePlacement(active, shownActive) && samePlacement(ghost, shownGhost))
+	{
+		return;
+	}
+
+	//The active tetromino goes on last so that it covers the ghost where they overlap
+	cover(shownActive, 0);
+	cover(shownGhost, 0);
+	cover(ghost, ghostFlag);
+	cover(active, 1);
+	shownActive = active;
+	shownGhost = ghost;
+}
+
+//Marks every cell dirty, for a canvas that does not keep what it drew
+void boardView::markAll()
+{
+	std::fill(dirtyRows, dirtyRows + numRows, board::fullRow);
+}
+
+//Clears the dirty masks once the dirty cells are drawn
+void boardView::clearDirty()
+{
+	std::fill(dirtyRows, dirtyRows + numRows, 0);
+}
@@ -0,0 +1,64 @@
+#ifndef BOARD_VIEW_HPP
+#define BOARD_VIEW_HPP
+
+#include <cstdint>
+#include "board.hpp"
+#include "game.hpp"
+#include "tetromino.hpp"
+
+/* What a window shows of a game's board: one byte per cell in row-major order and a dirty column mask per row
+The low four bits of a cell are the color of its locked block and the next three the color of the active or ghost
+tetromino covering it, which is drawn over the locked block; the top bit marks the cover as the ghost
+Nothing here depends on how the cells are drawn, so many views fit in memory at once, and their geometry is
+worked out from the cell coordinates when they are drawn */
+class boardView
+{
+	public:
+		static constexpr std::uint8_t lockedMask = 0x0F;
+		static constexpr int coverShift = 4;
+		static constexpr std::uint8_t coverMask = 0x70;
+		static constexpr std::uint8_t ghostFlag = 0x80;
+
+	private:
+		std::uint8_t cells[numRows * numColumns];
+		std::uint16_t dirtyRows[numRows];
+		tetromino shownActive;
+		tetromino shownGhost;
+
+		void cover(const tetromino &piece, std::uint8_t flags);
+
+	public:
+		boardView();
+
+		void update(const gameState &game, bool boardChanged);
+		void markAll();
+		std::uint8_t returnCell(int x, int y) const;
+		std::uint16_t returnDirtyRow(int y) const;
+		void clearDirty();
+};
+
+//Returns the color index a cell of a view is drawn in, 0 when it is empty
+inline int shownColor(std::uint8_t cell)
+{
+	return (cell & boardView::coverMask) ? (cell & boardView::coverMask) >> boardView::coverShift : cell & boardView::lockedMask;
+}
+
+//Returns whether a cell of a view is drawn as the ghost tetromino
+inline bool isGhostCell(std::uint8_t cell)
+{
+	return cell & boardView::ghostFlag;
+}
+
+//Returns the byte of the cell at (x, y)
+inline std::uint8_t boardView::returnCell(int x, int y) const
+{
+	return cells[y * numColumns + x];
+}
+
+//Returns the columns of a row that changed since the dirty masks were last cleared
+inline std::uint16_t boardView::returnDirtyRow(int y) const
+{
+	return dirtyRows[y];
+}
+
+#endif
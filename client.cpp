@@ -0,0 +1,133 @@
+#include <algorithm>
+#include <poll.h>
+#include <stdexcept>
+#include "client.hpp"
+
+//Constructor connecting to the server and asking for a match
+matchClient::matchClient(const std::string &address) : link(connectSocket(address))
+{
+	requeue();
+}
+
+//Waits up to timeoutMs for the server, then handles every message it sent and sends what is queued
+//Returns false once the server closed the connection
+bool matchClient::poll(int timeoutMs)
+{
+	pollfd waitFor = {link.returnFd(), short(POLLIN | (link.hasPending() ? POLLOUT : 0)), 0};
+	if (::poll(&waitFor, 1, timeoutMs) < 0)
+	{
+		return true;
+	}
+
+	bool open = link.receive();
+	const std::uint8_t *data;
+	std::size_t size;
+	while (link.nextMessage(data, size))
+	{
+		byteReader in(data, size);
+		handleMessage(in);
+	}
+	return link.flush() && open;
+}
+
+//Handles one message of the server
+void matchClient::handleMessage(byteReader &in)
+{
+	std::uint8_t type = in.readByte();
+	if (type == messageMatchStart)
+	{
+		info = readMatchStart(in);
+		std::fill(views, views + maxPlayersPerMatch, playerView());
+		inMatch = true;
+		winner = -1;
+	}
+	else if (type == messageUpdate)
+	{
+		const playerView &view = views[readUpdate(in, views, info.numPlayers)];
+		updates++;
+		if (std::uint32_t(view.toBoard().returnHash()) != view.boardHash)
+		{
+			hashMismatches++;
+		}
+	}
+	else if (type == messageMatchEnd)
+	{
+		winner = readMatchEnd(in);
+		inMatch = false;
+		matchesPlayed++;
+	}
+	else
+	{
+		throw std::runtime_error("Unexpected message from the server");
+	}
+}
+
+//Sends the keys of one input frame, which the server applies on its next tick
+void matchClient::sendInput(input in)
+{
+	writeInputFrame(link.startMessage(), nextInput++, in);
+	link.endMessage();
+	link.flush();
+}
+
+//Asks for another match once the last one ended
+void matchClient::requeue()
+{
+	writeHello(link.startMessage());
+	link.endMessage();
+	link.flush();
+}
+
+//Returns whether a match is being played
+bool matchClient::isInMatch() const
+{
+	return inMatch;
+}
+
+//Returns the slot, players, seed and rules of the current or last match
+const matchInfo &matchClient::returnInfo() const
+{
+	return info;
+}
+
+//Returns what the client knows of the game of a player of its match
+const playerView &matchClient::returnView(int slot) const
+{
+	return views[slot];
+}
+
+//Returns the slot of the winner of the last match, -1 if nobody won
+int matchClient::returnWinner() const
+{
+	return winner;
+}
+
+//Returns the number of matches that ended
+std::uint64_t matchClient::returnMatchesPlayed() const
+{
+	return matchesPlayed;
+}
+
+//Returns the number of board updates received
+std::uint64_t matchClient::returnUpdates() const
+{
+	return updates;
+}
+
+//Returns the number of board updates after which the rebuilt board did not match the server's hash
+std::uint64_t matchClient::returnHashMismatches() const
+{
+	return hashMismatches;
+}
+
+//Returns the number of bytes sent to the server
+std::uint64_t matchClient::returnBytesSent() const
+{
+	return link.returnBytesSent();
+}
+
+//Returns the number of bytes received from the server
+std::uint64_t matchClient::returnBytesReceived() const
+{
+	return link.returnBytesReceived();
+}
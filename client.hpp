@@ -0,0 +1,46 @@
+#ifndef CLIENT_HPP
+#define CLIENT_HPP
+
+#include <cstdint>
+#include <string>
+#include "game.hpp"
+#include "net.hpp"
+#include "protocol.hpp"
+
+//Client of a match server: says hello, sends input frames and keeps a view of every game of its match
+//up to date from the board updates it receives
+class matchClient
+{
+	private:
+		connection link;
+		matchInfo info;
+		bool inMatch = false;
+		int winner = -1;
+		std::uint64_t matchesPlayed = 0;
+		playerView views[maxPlayersPerMatch];
+		std::uint64_t nextInput = 1;
+		std::uint64_t updates = 0;
+		//Updates after which a rebuilt board did not hash to what the server sent
+		std::uint64_t hashMismatches = 0;
+
+		void handleMessage(byteReader &in);
+
+	public:
+		matchClient(const std::string &address);
+
+		bool poll(int timeoutMs);
+		void sendInput(input in);
+		void requeue();
+
+		bool isInMatch() const;
+		const matchInfo &returnInfo() const;
+		const playerView &returnView(int slot) const;
+		int returnWinner() const;
+		std::uint64_t returnMatchesPlayed() const;
+		std::uint64_t returnUpdates() const;
+		std::uint64_t returnHashMismatches() const;
+		std::uint64_t returnBytesSent() const;
+		std::uint64_t returnBytesReceived() const;
+};
+
+#endif
@@ -0,0 +1,270 @@
+#include <algorithm>
+#include <stdexcept>
+#include "corpus.hpp"
+#include "serial.hpp"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define CORPUS_MMAP 1
+#endif
+
+//Constructor creating the file and reserving room for the header
+corpusWriter::corpusWriter(const std::string &path, const gameRules &setRules) : rules(setRules)
+{
+	file = std::fopen(path.c_str(), "wb");
+	if (!file)
+	{
+		throw std::runtime_error("Could not create " + path);
+	}
+
+	writeHeader(0);
+	offset = corpusHeaderSize;
+}
+
+//Destructor closing the file if close was not called
+corpusWriter::~corpusWriter()
+{
+	if (file)
+	{
+		try
+		{
+			close();
+		}
+		catch(std::exception const &)
+		{
+		}
+	}
+}
+
+//Writes the header at the start of the file
+void corpusWriter::writeHeader(std::uint64_t indexOffset)
+{
+	std::vector<std::uint8_t> header;
+	byteWriter out(header);
+	out.writeU32(corpusMagic);
+	out.writeU16(corpusVersion);
+	out.writeU16(0);
+	out.writeU64(gameCount);
+	out.writeU64(indexOffset);
+	writeRules(out, rules);
+
+	std::fseek(file, 0, SEEK_SET);
+	if (std::fwrite(header.data(), 1, header.size(), file) != header.size())
+	{
+		throw std::runtime_error("Could not write corpus header");
+	}
+}
+
+//Appends the input stream of one game and records it in the index
+void corpusWriter::addGame(unsigned seed, std::uint64_t tickCount, const std::vector<std::uint8_t> &inputs)
+{
+	if (!file)
+	{
+		throw std::runtime_error("Corpus already closed");
+	}
+	if (!inputs.empty() && std::fwrite(inputs.data(), 1, inputs.size(), file) != inputs.size())
+	{
+		throw std::runtime_error("Could not write corpus game");
+	}
+
+	byteWriter out(index);
+	out.writeU64(offset);
+	out.writeU64(inputs.size());
+	out.writeU64(tickCount);
+	out.writeU32(seed);
+	out.writeU32(0);
+
+	offset += inputs.size();
+	gameCount++;
+}
+
+//Writes the index after the last game, fills in the header and closes the file
+void corpusWriter::close()
+{
+	std::FILE *closing = file;
+	if (!index.empty() && std::fwrite(index.data(), 1, index.size(), closing) != index.size())
+	{
+		file = nullptr;
+		std::fclose(closing);
+		throw std::runtime_error("Could not write corpus index");
+	}
+
+	writeHeader(offset);
+	file = nullptr;
+	if (std::fclose(closing) != 0)
+	{
+		throw std::runtime_error("Could not close corpus");
+	}
+}
+
+//Constructor mapping the whole file read only
+mappedFile::mappedFile(const std::string &path)
+{
+#ifdef CORPUS_MMAP
+	int descriptor = open(path.c_str(), O_RDONLY);
+	if (descriptor < 0)
+	{
+		throw std::runtime_error("Could not open " + path);
+	}
+
+	struct stat info;
+	if (fstat(descriptor, &info) != 0)
+	{
+		::close(descriptor);
+		throw std::runtime_error("Could not stat " + path);
+	}
+
+	size = info.st_size;
+	if (size > 0)
+	{
+		void *mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+		if (mapping == MAP_FAILED)
+		{
+			::close(descriptor);
+			throw std::runtime_error("Could not map " + path);
+		}
+		//Games are mostly read front to back
+		madvise(mapping, size, MADV_SEQUENTIAL);
+		data = static_cast<const std::uint8_t *>(mapping);
+	}
+	::close(descriptor);
+#else
+	fallback = readFileBytes(path);
+	data = fallback.data();
+	size = fallback.size();
+#endif
+}
+
+//Destructor unmapping the file
+mappedFile::~mappedFile()
+{
+#ifdef CORPUS_MMAP
+	if (data)
+	{
+		munmap(const_cast<std::uint8_t *>(data), size);
+	}
+#endif
+}
+
+//Returns the first byte of the file
+const std::uint8_t *mappedFile::returnData() const
+{
+	return data;
+}
+
+//Returns the size of the file in bytes
+std::size_t mappedFile::returnSize() const
+{
+	return size;
+}
+
+//Constructor mapping a corpus and checking its header and index bounds
+corpusReader::corpusReader(const std::string &path) : file(path)
+{
+	byteReader in(file.returnData(), file.returnSize());
+	if (file.returnSize() < corpusHeaderSize || in.readU32() != corpusMagic)
+	{
+		throw std::runtime_error("Not a corpus file");
+	}
+	if (in.readU16() != corpusVersion)
+	{
+		throw std::runtime_error("Unsupported corpus version");
+	}
+	in.readU16();
+
+	gameCount = in.readU64();
+	indexOffset = in.readU64();
+	rules = readRules(in);
+	if (indexOffset < corpusHeaderSize || indexOffset > file.returnSize() || gameCount > (file.returnSize() - indexOffset) / corpusIndexEntrySize)
+	{
+		throw std::runtime_error("Corpus index out of bounds");
+	}
+}
+
+//Returns the number of games in the corpus
+std::uint64_t corpusReader::returnGameCount() const
+{
+	return gameCount;
+}
+
+//Returns the rules every game of the corpus was played with
+const gameRules &corpusReader::returnRules() const
+{
+	return rules;
+}
+
+//Returns game i, whose input stream is read straight from the mapping
+corpusGame corpusReader::returnGame(std::uint64_t i) const
+{
+	if (i >= gameCount)
+	{
+		throw std::runtime_error("Corpus game out of range");
+	}
+
+	byteReader in(file.returnData() + indexOffset + i * corpusIndexEntrySize, corpusIndexEntrySize);
+	std::uint64_t inputsOffset = in.readU64();
+	std::uint64_t inputsSize = in.readU64();
+	corpusGame recorded;
+	recorded.tickCount = in.readU64();
+	recorded.seed = in.readU32();
+	if (inputsOffset < corpusHeaderSize || inputsOffset > indexOffset || inputsSize > indexOffset - inputsOffset)
+	{
+		throw std::runtime_error("Corpus game out of bounds");
+	}
+
+	recorded.inputs = file.returnData() + inputsOffset;
+	recorded.inputsSize = inputsSize;
+	return recorded;
+}
+
+//Adds the totals of another set of games
+void corpusStats::add(const corpusStats &other)
+{
+	games += other.games;
+	ticks += other.ticks;
+	losses += other.losses;
+	pieces += other.pieces;
+	lines += other.lines;
+	score += other.score;
+	maxScore = std::max(maxScore, other.maxScore);
+	for (int i = 0; i < 4; i++)
+	{
+		clears[i] += other.clears[i];
+	}
+}
+
+//Re-simulates a recorded game and totals what happened in it
+//Like the replay player, a lost game starts over and the score it reached is added to the total
+corpusStats simulateGame(const corpusGame &recorded, const gameRules &rules)
+{
+	corpusStats stats;
+	stats.games = 1;
+	gameState game(recorded.seed, rules);
+	inputStreamReader inputs(recorded.inputs, recorded.inputsSize);
+	for (std::uint64_t tick = 0; tick < recorded.tickCount; tick++)
+	{
+		stepResult result = game.step(inputs.next());
+		stats.pieces += result.locked;
+		if (result.linesCleared > 0)
+		{
+			stats.lines += result.linesCleared;
+			stats.clears[std::min(result.linesCleared, 4) - 1]++;
+		}
+
+		if (result.lost)
+		{
+			stats.losses++;
+			stats.score += game.returnScore();
+			stats.maxScore = std::max<std::uint64_t>(stats.maxScore, game.returnScore());
+			game.restart();
+		}
+	}
+
+	stats.score += game.returnScore();
+	stats.maxScore = std::max<std::uint64_t>(stats.maxScore, game.returnScore());
+	stats.ticks = recorded.tickCount;
+	return stats;
+}
@@ -0,0 +1,110 @@
+#ifndef CORPUS_HPP
+#define CORPUS_HPP
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "game.hpp"
+#include "replay.hpp"
+
+/* Corpus file layout, integers little endian
+Header of corpusHeaderSize bytes: u32 magic "TTCP", u16 version, u16 reserved, u64 game count, u64 index offset,
+rules: gravity table of numLevels bytes, u8 randomizer, u8 preview length, u8 lock delay
+Input streams of every game back to back, encoded like the input stream of a replay
+Index at the index offset: one corpusIndexEntrySize record per game of u64 input offset, u64 input size,
+u64 tick count, u32 seed, u32 reserved */
+constexpr std::uint32_t corpusMagic = 0x50435454;
+//Version 2 records the randomizer and preview length
+//Version 3 games turn with SRS orientations and kicks and record their lock delay
+//Version 4 inputs carry auto repeated side moves
+//Version 5 games cap how often moving a tetromino off the stack restarts its lock delay
+//Version 6 games are lost as soon as a tetromino spawns overlapping the stack
+constexpr std::uint16_t corpusVersion = 6;
+constexpr std::size_t corpusHeaderSize = 24 + numLevels + 3;
+constexpr std::size_t corpusIndexEntrySize = 32;
+
+//One game of a corpus; the input stream points into the mapped file
+struct corpusGame
+{
+	unsigned seed;
+	std::uint64_t tickCount;
+	const std::uint8_t *inputs;
+	std::size_t inputsSize;
+};
+
+//Appends games to a corpus file, writing the index when it is closed
+class corpusWriter
+{
+	private:
+		std::FILE *file;
+		gameRules rules;
+		std::vector<std::uint8_t> index;
+		std::uint64_t gameCount = 0;
+		std::uint64_t offset = 0;
+
+		void writeHeader(std::uint64_t indexOffset);
+
+	public:
+		corpusWriter(const std::string &path, const gameRules &setRules = gameRules());
+		~corpusWriter();
+
+		void addGame(unsigned seed, std::uint64_t tickCount, const std::vector<std::uint8_t> &inputs);
+		void close();
+};
+
+//Read only view of a whole file, memory mapped where the platform supports it
+class mappedFile
+{
+	private:
+		const std::uint8_t *data = nullptr;
+		std::size_t size = 0;
+		//Holds the contents on platforms without memory mapping
+		std::vector<std::uint8_t> fallback;
+
+	public:
+		mappedFile(const std::string &path);
+		~mappedFile();
+		mappedFile(const mappedFile &) = delete;
+		mappedFile &operator=(const mappedFile &) = delete;
+
+		const std::uint8_t *returnData() const;
+		std::size_t returnSize() const;
+};
+
+//Reads the games of a corpus in place from a mapped file
+class corpusReader
+{
+	private:
+		mappedFile file;
+		std::uint64_t gameCount;
+		std::uint64_t indexOffset;
+		gameRules rules;
+
+	public:
+		corpusReader(const std::string &path);
+
+		std::uint64_t returnGameCount() const;
+		const gameRules &returnRules() const;
+		corpusGame returnGame(std::uint64_t i) const;
+};
+
+//Totals of re-simulating one or more games
+struct corpusStats
+{
+	std::uint64_t games = 0;
+	std::uint64_t ticks = 0;
+	std::uint64_t losses = 0;
+	std::uint64_t pieces = 0;
+	std::uint64_t lines = 0;
+	std::uint64_t score = 0;
+	std::uint64_t maxScore = 0;
+	//Line clears of one, two, three and four rows
+	std::uint64_t clears[4] = {};
+
+	void add(const corpusStats &other);
+};
+
+corpusStats simulateGame(const corpusGame &recorded, const gameRules &rules);
+
+#endif
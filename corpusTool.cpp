@@ -0,0 +1,240 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "corpus.hpp"
+#include "policy.hpp"
+#include "replay.hpp"
+#include "threadPool.hpp"
+
+//Games generated in parallel before they are written, bounding the memory held by their input streams
+constexpr std::uint64_t generateChunk = 16384;
+
+//Totals kept by one worker so that workers never write to shared memory while simulating
+struct alignas(64) workerStats
+{
+	corpusStats stats;
+};
+
+//Prints how to call the corpus tool
+void printUsage()
+{
+	std::cerr << "Usage: tetris_corpus pack <out> <replay>...\n";
+	std::cerr << "       tetris_corpus generate <out> [--games N] [--seed S] [--threads T] [--policy idle|random|ai] [--max-ticks M] [--randomizer classic|bag|history]\n";
+	std::cerr << "       tetris_corpus stats <file> [--threads T]\n";
+}
+
+//Packs replay files into a corpus, copying their input streams as they are
+void packReplays(const std::string &out, const std::vector<std::string> &replays)
+{
+	if (replays.empty())
+	{
+		throw std::runtime_error("No replays to pack");
+	}
+
+	//A corpus has a single set of rules, taken from the first replay
+	gameRules rules = replayPlayer(readFileBytes(replays[0])).returnRules();
+	corpusWriter writer(out, rules);
+	for (int i = 0; i < replays.size(); i++)
+	{
+		replayPlayer player(readFileBytes(replays[i]));
+		if (!sameRules(rules, player.returnRules()))
+		{
+			throw std::runtime_error(replays[i] + " was played with different rules");
+		}
+
+		const std::uint8_t *inputs = player.returnInputData();
+		writer.addGame(player.returnSeed(), player.returnTickCount(), std::vector<std::uint8_t>(inputs, inputs + player.returnInputSize()));
+	}
+	writer.close();
+
+	std::cout << "packed       " << replays.size() << " replays into " << out << "\n";
+}
+
+//Plays seeded games with an input policy like tetris_batch and writes them to a corpus in game order
+void generateGames(const std::string &out, int argc, char **argv)
+{
+	std::uint64_t games = 10000;
+	std::uint64_t baseSeed = 1;
+	int threads = 0;
+	policyType policyKind = policyRandom;
+	std::uint64_t maxTicks = 100000;
+	gameRules rules;
+	for (int i = 0; i < argc; i++)
+	{
+		std::string arg = argv[i];
+		if (i + 1 >= argc)
+		{
+			throw std::runtime_error("Missing value for " + arg);
+		}
+
+		std::string value = argv[++i];
+		if (arg == "--games")
+		{
+			games = std::stoull(value);
+		}
+		else if (arg == "--seed")
+		{
+			baseSeed = std::stoull(value);
+		}
+		else if (arg == "--threads")
+		{
+			threads = std::stoi(value);
+		}
+		else if (arg == "--policy")
+		{
+			policyKind = parsePolicy(value);
+		}
+		else if (arg == "--max-ticks")
+		{
+			maxTicks = std::stoull(value);
+		}
+		else if (arg == "--randomizer")
+		{
+			rules.randomizer = parseRandomizer(value);
+		}
+		else
+		{
+			throw std::runtime_error("Unknown option " + arg);
+		}
+	}
+
+	workStealingPool pool(threads);
+	std::vector<inputStreamWriter> streams(pool.returnNumThreads());
+	std::vector<std::vector<std::uint8_t>> chunkInputs(std::min(games, generateChunk));
+	std::vector<std::uint64_t> chunkTicks(chunkInputs.size());
+	corpusWriter writer(out, rules);
+	auto start = std::chrono::steady_clock::now();
+
+	for (std::uint64_t chunkStart = 0; chunkStart < games; chunkStart += generateChunk)
+	{
+		std::uint64_t chunkSize = std::min(generateChunk, games - chunkStart);
+		pool.parallelFor(chunkSize, 64, [&](int worker, std::uint64_t begin, std::uint64_t end)
+		{
+			inputStreamWriter &stream = streams[worker];
+			for (std::uint64_t i = begin; i < end; i++)
+			{
+				unsigned seed = gameSeed(baseSeed, chunkStart + i);
+				gameState game(seed, rules);
+				inputPolicy policy(policyKind, seed);
+				std::uint64_t ticks = 0;
+				stream.clear();
+				while (!game.isGameOver() && ticks < maxTicks)
+				{
+					input in = policy.nextInput(game);
+					stream.append(in);
+					game.step(in);
+					ticks++;
+				}
+
+				chunkInputs[i] = stream.finish();
+				chunkTicks[i] = ticks;
+			}
+		});
+
+		for (std::uint64_t i = 0; i < chunkSize; i++)
+		{
+			writer.addGame(gameSeed(baseSeed, chunkStart + i), chunkTicks[i], chunkInputs[i]);
+		}
+	}
+	writer.close();
+
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	std::cout << "generated    " << games << " games into " << out << " in " << seconds << " s\n";
+}
+
+//Re-simulates every game of a corpus across the worker threads and prints the totals
+void printStats(const std::string &path, int argc, char **argv)
+{
+	int threads = 0;
+	for (int i = 0; i < argc; i++)
+	{
+		std::string arg = argv[i];
+		if (arg == "--threads" && i + 1 < argc)
+		{
+			threads = std::stoi(argv[++i]);
+		}
+		else
+		{
+			throw std::runtime_error("Unknown option " + arg);
+		}
+	}
+
+	corpusReader reader(path);
+	workStealingPool pool(threads);
+	std::vector<workerStats> workers(pool.returnNumThreads());
+	auto start = std::chrono::steady_clock::now();
+
+	pool.parallelFor(reader.returnGameCount(), 64, [&](int worker, std::uint64_t begin, std::uint64_t end)
+	{
+		corpusStats &stats = workers[worker].stats;
+		for (std::uint64_t i = begin; i < end; i++)
+		{
+			stats.add(simulateGame(reader.returnGame(i), reader.returnRules()));
+		}
+	});
+
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	corpusStats total;
+	for (int i = 0; i < workers.size(); i++)
+	{
+		total.add(workers[i].stats);
+	}
+
+	if (total.games == 0)
+	{
+		std::cout << "No games in corpus\n";
+		return;
+	}
+
+	double games = total.games;
+	std::cout << "games        " << total.games << " on " << pool.returnNumThreads() << " threads in " << seconds << " s\n";
+	std::cout << "games/sec    " << games / seconds << "\n";
+	std::cout << "ticks/sec    " << total.ticks / seconds << "\n";
+	std::cout << "losses       " << total.losses << "\n";
+	std::cout << "score        total " << total.score << " mean " << total.score / games << " max " << total.maxScore << "\n";
+	std::cout << "lines        total " << total.lines << " mean " << total.lines / games << "\n";
+	std::cout << "pieces       total " << total.pieces << " mean " << total.pieces / games << "\n";
+	std::cout << "clears       single " << total.clears[0] << " double " << total.clears[1] << " triple " << total.clears[2] << " tetris " << total.clears[3] << "\n";
+}
+
+int main(int argc, char **argv)
+{
+	if (argc < 3)
+	{
+		printUsage();
+		return 1;
+	}
+
+	try
+	{
+		std::string command = argv[1];
+		std::string path = argv[2];
+		if (command == "pack")
+		{
+			packReplays(path, std::vector<std::string>(argv + 3, argv + argc));
+		}
+		else if (command == "generate")
+		{
+			generateGames(path, argc - 3, argv + 3);
+		}
+		else if (command == "stats")
+		{
+			printStats(path, argc - 3, argv + 3);
+		}
+		else
+		{
+			printUsage();
+			return 1;
+		}
+	}
+	catch(std::exception const &e)
+	{
+		std::cerr << "Exception: " << e.what() << "\n";
+		return 1;
+	}
+}
@@ -0,0 +1,724 @@
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include "game.hpp"
+#include "instrument.hpp"
+
+//Constructor seeding the randomizer, setting the rules and spawning the first tetromino
+template <int setWidth, int setHeight>
+basicGameState<setWidth, setHeight>::basicGameState(unsigned seed, const gameRules &rules) : activeTet(0, setWidth / 2), randomizer(rules.randomizer, seed), gravity(rules.gravity), lockDelay(std::max(0, std::min(rules.lockDelay, 255)))
+{
+	previewCount = std::max(0, std::min(rules.previewCount, maxPreviewLength));
+	activeTet = tetromino(randomizer.next(), setWidth / 2);
+	lowestRow = activeTet.returnPosition().y;
+	for (int i = 0; i < previewCount; i++)
+	{
+		preview[i] = randomizer.next();
+	}
+}
+
+//Returns the shape of the next tetromino and draws one more into the preview
+template <int setWidth, int setHeight>
+int basicGameState<setWidth, setHeight>::takeNextShape()
+{
+	if (previewCount == 0)
+	{
+		return randomizer.next();
+	}
+
+	int shape = preview[0];
+	std::copy(preview + 1, preview + previewCount, preview);
+	preview[previewCount - 1] = randomizer.next();
+	return shape;
+}
+
+//Moves or rotates the active tetromino for every input flag that is set, if the board allows it
+template <int setWidth, int setHeight>
+void basicGameState<setWidth, setHeight>::applyInput(input in)
+{
+	if (gameOver)
+	{
+		return;
+	}
+
+	//Holding swaps the active tetromino with the held one, or with the next one while the slot is empty,
+	//and the tetromino that comes out starts again from the spawn position, losing the game if it has no room there
+	if ((in.flags & inputHold) && !holdUsed)
+	{
+		int shape = activeTet.returnShape();
+		activeTet = tetromino(heldShape >= 0 ? heldShape : takeNextShape(), setWidth / 2);
+		heldShape = shape;
+		holdUsed = true;
+		lowestRow = activeTet.returnPosition().y;
+		lockResets = 0;
+		if (!pieceFits(field, activeTet.returnShape(), activeTet.returnRotation(), activeTet.returnPosition().x, activeTet.returnPosition().y))
+		{
+			gameOver = true;
+			return;
+		}
+	}
+
+	//A side move is repeated until the repeats run out or the tetromino runs into something
+	for (int i = 0; (in.flags & inputLeft) && i <= in.repeats && canMove(activeTet, field, 1); i++)
+	{
+		activeTet.move(1);
+		lastMoveTurned = false;
+	}
+	for (int i = 0; (in.flags & inputRight) && i <= in.repeats && canMove(activeTet, field, 3); i++)
+	{
+		activeTet.move(3);
+		lastMoveTurned = false;
+	}
+	//Turns take the first SRS kick that fits, so a piece against a wall or the stack still turns where it can
+	if (in.flags & inputRotate)
+	{
+		turn(1);
+	}
+	if (in.flags & inputRotateCcw)
+	{
+		turn(-1);
+	}
+	if (in.flags & inputRotateHalf)
+	{
+		turn(2);
+	}
+	if ((in.flags & inputDown) && canMove(activeTet, field, 2))
+	{
+		activeTet.move(2);
+		lastMoveTurned = false;
+	}
+	if (in.flags & inputHardDrop)
+	{
+		tetromino landed = returnGhost();
+		lastMoveTurned = lastMoveTurned && landed.returnPosition().y == activeTet.returnPosition().y;
+		activeTet = landed;
+	}
+}
+
+//Turns the active tetromino with the first kick that fits, remembering the kick for T-spins
+template <int setWidth, int setHeight>
+void basicGameState<setWidth, setHeight>::turn(int direction)
+{
+	if (rotateWithKicks(activeTet, field, direction, &lastKick))
+	{
+		lastMoveTurned = true;
+	}
+}
+
+//Returns the kind of T-spin locking the active tetromino where it is would be
+//A T that last moved by turning is a T-spin when three of the four cells diagonal to its center are blocked, walls
+//and floor included; it is a full one when both cells on the side it points to are blocked or it took the last kick,
+//and a mini otherwise
+template <int setWidth, int setHeight>
+tSpinType basicGameState<setWidth, setHeight>::findTSpin() const
+{
+	if (activeTet.returnShape() != 2 || !lastMoveTurned)
+	{
+		return tSpinNone;
+	}
+
+	//Corners in the order top left, top right, bottom right, bottom left, and the two each rotation points to
+	const int cornerX[4] = {-1, 1, 1, -1};
+	const int cornerY[4] = {-1, -1, 1, 1};
+	const int frontCorners[numRotations][2] = {{0, 1}, {1, 2}, {2, 3}, {3, 0}};
+	position p = activeTet.returnPosition();
+	bool blocked[4];
+	int blockedCount = 0;
+	for (int i = 0; i < 4; i++)
+	{
+		blocked[i] = field.isOccupied(p.x + cornerX[i], p.y + cornerY[i]);
+		blockedCount += blocked[i];
+	}
+	if (blockedCount < 3)
+	{
+		return tSpinNone;
+	}
+
+	const int *front = frontCorners[activeTet.returnRotation()];
+	return (blocked[front[0]] && blocked[front[1]]) || lastKick == 4 ? tSpinFull : tSpinMini;
+}
+
+//Takes an attack off the incoming garbage, oldest first, and returns what is left of it to send
+template <int setWidth, int setHeight>
+int basicGameState<setWidth, setHeight>::cancelGarbage(int attack)
+{
+	int cancelled = 0;
+	while (attack > 0 && cancelled < incomingCount)
+	{
+		int taken = std::min<int>(attack, incoming[cancelled].rows);
+		attack -= taken;
+		incoming[cancelled].rows -= taken;
+		if (incoming[cancelled].rows == 0)
+		{
+			cancelled++;
+		}
+	}
+
+	std::copy(incoming + cancelled, incoming + incomingCount, incoming);
+	incomingCount -= cancelled;
+	return attack;
+}
+
+//Applies the given input and then advances the game by one tick
+template <int setWidth, int setHeight>
+stepResult basicGameState<setWidth, setHeight>::step(input in)
+{
+	stepResult result;
+	if (gameOver)
+	{
+		return result;
+	}
+
+	applyInput(in);
+	if (gameOver)
+	{
+		result.lost = true;
+		return result;
+	}
+
+	//Gravity only acts once the delay of the current level has passed
+	//A tetromino resting on the stack locks once the lock delay runs out, and a hard dropped one straight away
+	//Moving or turning a grounded tetromino off the stack restarts the count, but only maxLockResets times until it
+	//reaches a row lower than before, so that it cannot be kept off the stack forever
+	bool hardDrop = in.flags & inputHardDrop;
+	gravityCounter++;
+	if (activeTet.returnPosition().y > lowestRow)
+	{
+		lowestRow = activeTet.returnPosition().y;
+		lockResets = 0;
+		groundedTicks = 0;
+	}
+	if (!hardDrop && canMove(activeTet, field, 2))
+	{
+		if (groundedTicks > 0 && lockResets < maxLockResets)
+		{
+			lockResets++;
+			groundedTicks = 0;
+		}
+		if (gravityCounter < gravity.ticksPerRow[level])
+		{
+			return result;
+		}
+		gravityCounter = 0;
+		activeTet.move(2);
+		lastMoveTurned = false;
+		return result;
+	}
+	if (!hardDrop && ++groundedTicks < lockDelay)
+	{
+		return result;
+	}
+	gravityCounter = 0;
+	groundedTicks = 0;
+
+	//Spawn a new tetromino and decompose the previous tetromino
+	//Locking any block above the top row loses the game, as does the next tetromino having no room once full rows are
+	//cleared, with any of its cells overlapping the stack
+	bool lockedOut = isLockedOut(activeTet);
+	result.tSpin = findTSpin();
+	lastMoveTurned = false;
+	activeTet.decompose(field);
+	activeTet = tetromino(takeNextShape(), setWidth / 2);
+	holdUsed = false;
+	lowestRow = activeTet.returnPosition().y;
+	lockResets = 0;
+	piecesPlaced++;
+	result.locked = true;
+
+	//Loss checking
+	if (lockedOut)
+	{
+		gameOver = true;
+		result.lost = true;
+		return result;
+	}
+
+	//Line checking
+	{
+		scopedTimer timer(phaseLineClear);
+		result.linesCleared = field.clearFullRows();
+	}
+	if (!pieceFits(field, activeTet.returnShape(), activeTet.returnRotation(), activeTet.returnPosition().x, activeTet.returnPosition().y))
+	{
+		gameOver = true;
+		result.lost = true;
+		return result;
+	}
+
+	score += scoreForLines(result.linesCleared);
+	totalLines += result.linesCleared;
+	level = totalLines / 10 < numLevels ? totalLines / 10 : numLevels - 1;
+
+	//A clear attacks and cancels incoming garbage; a lock that clears nothing ends the combo and lets the garbage rise
+	if (result.linesCleared > 0)
+	{
+		bool difficult = result.linesCleared == 4 || result.tSpin != tSpinNone;
+		combo++;
+		result.combo = combo;
+		result.backToBack = difficult && backToBack;
+		backToBack = difficult;
+		result.attack = cancelGarbage(attackForClear(result.linesCleared, result.tSpin, result.backToBack, combo));
+		return result;
+	}
+
+	combo = -1;
+	bool toppedOut = false;
+	for (int i = 0; i < incomingCount; i++)
+	{
+		toppedOut = field.addGarbageRows(incoming[i].rows, incoming[i].holeColumn) || toppedOut;
+		result.garbageAdded += incoming[i].rows;
+	}
+	incomingCount = 0;
+	if (toppedOut || (result.garbageAdded > 0 && !pieceFits(field, activeTet.returnShape(), activeTet.returnRotation(), activeTet.returnPosition().x, activeTet.returnPosition().y)))
+	{
+		gameOver = true;
+		result.lost = true;
+	}
+
+	return result;
+}
+
+//Empties the board and the hold slot and resets the score after a loss, keeping the active tetromino and the piece sequence
+template <int setWidth, int setHeight>
+void basicGameState<setWidth, setHeight>::restart()
+{
+	field.clear();
+	score = 0;
+	totalLines = 0;
+	piecesPlaced = 0;
+	level = 0;
+	gravityCounter = 0;
+	groundedTicks = 0;
+	lowestRow = activeTet.returnPosition().y;
+	lockResets = 0;
+	lastMoveTurned = false;
+	combo = -1;
+	backToBack = false;
+	incomingCount = 0;
+	heldShape = -1;
+	holdUsed = false;
+	gameOver = false;
+}
+
+//Replaces the board of locked blocks, for starting from a prepared position
+template <int setWidth, int setHeight>
+void basicGameState<setWidth, setHeight>::loadBoard(const boardType &startField)
+{
+	field = startField;
+}
+
+//Queues garbage sent by an opponent, with its hole in holeColumn wrapped onto the board, to rise in after the next lock that clears nothing
+template <int setWidth, int setHeight>
+void basicGameState<setWidth, setHeight>::receiveGarbage(int rows, int holeColumn)
+{
+	if (rows <= 0 || gameOver)
+	{
+		return;
+	}
+
+	rows = std::min(rows, setHeight);
+	holeColumn = (holeColumn % setWidth + setWidth) % setWidth;
+	if (incomingCount < maxGarbageBatches)
+	{
+		incoming[incomingCount++] = {std::uint8_t(rows), std::uint8_t(holeColumn)};
+	}
+	else
+	{
+		garbageBatch &last = incoming[maxGarbageBatches - 1];
+		last.rows = std::uint8_t(std::min(last.rows + rows, setHeight));
+	}
+}
+
+//Writes everything that changes while playing, so that load restores the game exactly
+//The gravity table is not written; it is fixed for the whole game
+template <int setWidth, int setHeight>
+void basicGameState<setWidth, setHeight>::save(byteWriter &out) const
+{
+	for (int y = 0; y < setHeight; y++)
+	{
+		for (int x = 0; x < setWidth; x += 2)
+		{
+			std::uint8_t high = x + 1 < setWidth ? field.returnColor(x + 1, y) : 0;
+			out.writeByte(field.returnColor(x, y) | (high << 4));
+		}
+	}
+
+	out.writeByte(activeTet.returnShape());
+	out.writeByte(activeTet.returnRotation());
+	out.writeSigned(activeTet.returnPosition().x);
+	out.writeSigned(activeTet.returnPosition().y);
+	out.writeByte(previewCount);
+	for (int i = 0; i < previewCount; i++)
+	{
+		out.writeByte(preview[i]);
+	}
+	out.writeSigned(heldShape);
+	out.writeByte(holdUsed);
+	randomizer.save(out);
+
+	out.writeVarint(score);
+	out.writeVarint(totalLines);
+	out.writeVarint(piecesPlaced);
+	out.writeVarint(level);
+	out.writeVarint(gravityCounter);
+	out.writeVarint(groundedTicks);
+	out.writeSigned(lowestRow);
+	out.writeByte(lockResets);
+	out.writeByte(lastMoveTurned | (backToBack << 1));
+	out.writeByte(lastKick);
+	out.writeSigned(combo);
+	out.writeByte(incomingCount);
+	for (int i = 0; i < incomingCount; i++)
+	{
+		out.writeByte(incoming[i].rows);
+		out.writeByte(incoming[i].holeColumn);
+	}
+	out.writeByte(gameOver);
+}
+
+//Restores a game written by save
+template <int setWidth, int setHeight>
+void basicGameState<setWidth, setHeight>::load(byteReader &in)
+{
+	field.clear();
+	for (int y = 0; y < setHeight; y++)
+	{
+		for (int x = 0; x < setWidth; x += 2)
+		{
+			std::uint8_t colors = in.readByte();
+			if (colors & 0xF)
+			{
+				field.fillCell(x, y, colors & 0xF);
+			}
+			if (colors >> 4)
+			{
+				field.fillCell(x + 1, y, colors >> 4);
+			}
+		}
+	}
+
+	int shape = in.readByte();
+	int rotation = in.readByte();
+	int x = in.readSigned();
+	int y = in.readSigned();
+	if (shape >= numShapes)
+	{
+		throw std::runtime_error("Invalid shape in saved game");
+	}
+	activeTet = tetromino(shape, setWidth / 2);
+	activeTet.setPlacement(x, y, rotation);
+	previewCount = in.readByte();
+	if (previewCount > maxPreviewLength)
+	{
+		throw std::runtime_error("Invalid preview length in saved game");
+	}
+	for (int i = 0; i < previewCount; i++)
+	{
+		preview[i] = in.readByte();
+		if (preview[i] >= numShapes)
+		{
+			throw std::runtime_error("Invalid preview shape in saved game");
+		}
+	}
+	heldShape = in.readSigned();
+	holdUsed = in.readByte();
+	if (heldShape < -1 || heldShape >= numShapes)
+	{
+		throw std::runtime_error("Invalid held shape in saved game");
+	}
+	randomizer.load(in);
+
+	score = in.readVarint();
+	totalLines = in.readVarint();
+	piecesPlaced = in.readVarint();
+	level = in.readVarint();
+	gravityCounter = in.readVarint();
+	groundedTicks = in.readVarint();
+	lowestRow = int(in.readSigned());
+	lockResets = in.readByte();
+	if (lockResets > maxLockResets)
+	{
+		throw std::runtime_error("Invalid lock delay restarts in saved game");
+	}
+	std::uint8_t flags = in.readByte();
+	lastMoveTurned = flags & 1;
+	backToBack = flags & 2;
+	lastKick = in.readByte();
+	combo = int(in.readSigned());
+	incomingCount = in.readByte();
+	if (incomingCount > maxGarbageBatches)
+	{
+		throw std::runtime_error("Invalid garbage queue in saved game");
+	}
+	for (int i = 0; i < incomingCount; i++)
+	{
+		incoming[i].rows = in.readByte();
+		incoming[i].holeColumn = in.readByte();
+		if (incoming[i].rows > setHeight || incoming[i].holeColumn >= setWidth)
+		{
+			throw std::runtime_error("Invalid garbage in saved game");
+		}
+	}
+	gameOver = in.readByte();
+	if (level >= numLevels)
+	{
+		throw std::runtime_error("Invalid level in saved game");
+	}
+}
+
+//Returns the board of locked blocks
+template <int setWidth, int setHeight>
+const typename basicGameState<setWidth, setHeight>::boardType &basicGameState<setWidth, setHeight>::returnBoard() const
+{
+	return field;
+}
+
+//Returns the falling tetromino
+template <int setWidth, int setHeight>
+const tetromino &basicGameState<setWidth, setHeight>::returnActive() const
+{
+	return activeTet;
+}
+
+//Returns the shape of the tetromino i places after the active one, 0 being the next
+template <int setWidth, int setHeight>
+int basicGameState<setWidth, setHeight>::returnPreview(int i) const
+{
+	return preview[i];
+}
+
+//Returns the active tetromino moved down to where it would land, found from the board's column masks
+template <int setWidth, int setHeight>
+tetromino basicGameState<setWidth, setHeight>::returnGhost() const
+{
+	tetromino ghost = activeTet;
+	position p = ghost.returnPosition();
+	ghost.setPlacement(p.x, p.y + dropDistance(ghost, field), ghost.returnRotation());
+	return ghost;
+}
+
+//Returns the number of tetrominos shown ahead of the active one
+template <int setWidth, int setHeight>
+int basicGameState<setWidth, setHeight>::returnPreviewCount() const
+{
+	return previewCount;
+}
+
+//Returns the shape in the hold slot, -1 if it is empty
+template <int setWidth, int setHeight>
+int basicGameState<setWidth, setHeight>::returnHeld() const
+{
+	return heldShape;
+}
+
+//Returns the rules the game was created with
+template <int setWidth, int setHeight>
+gameRules basicGameState<setWidth, setHeight>::returnRules() const
+{
+	gameRules rules;
+	rules.gravity = gravity;
+	rules.randomizer = randomizer.returnType();
+	rules.previewCount = previewCount;
+	rules.lockDelay = lockDelay;
+	return rules;
+}
+
+//Returns the score of the current game
+template <int setWidth, int setHeight>
+int basicGameState<setWidth, setHeight>::returnScore() const
+{
+	return score;
+}
+
+//Returns the number of lines cleared in the current game
+template <int setWidth, int setHeight>
+int basicGameState<setWidth, setHeight>::returnLines() const
+{
+	return totalLines;
+}
+
+//Returns the number of tetrominos locked in the current game
+template <int setWidth, int setHeight>
+int basicGameState<setWidth, setHeight>::returnPiecesPlaced() const
+{
+	return piecesPlaced;
+}
+
+//Returns the level, which goes up every 10 lines and sets the gravity
+template <int setWidth, int setHeight>
+int basicGameState<setWidth, setHeight>::returnLevel() const
+{
+	return level;
+}
+
+//Returns whether the last tetromino locked into the spawn cell
+template <int setWidth, int setHeight>
+bool basicGameState<setWidth, setHeight>::isGameOver() const
+{
+	return gameOver;
+}
+
+//Returns the number of garbage rows queued to rise into the board
+template <int setWidth, int setHeight>
+int basicGameState<setWidth, setHeight>::returnPendingGarbage() const
+{
+	int rows = 0;
+	for (int i = 0; i < incomingCount; i++)
+	{
+		rows += incoming[i].rows;
+	}
+	return rows;
+}
+
+//Returns the number of clearing locks in a row, -1 after a lock that cleared nothing
+template <int setWidth, int setHeight>
+int basicGameState<setWidth, setHeight>::returnCombo() const
+{
+	return combo;
+}
+
+//Returns whether the next tetris or T-spin clear earns the back-to-back bonus
+template <int setWidth, int setHeight>
+bool basicGameState<setWidth, setHeight>::returnBackToBack() const
+{
+	return backToBack;
+}
+
+//Every board size in boardSizes, which withBoardSize chooses from
+template class basicGameState<10, 20>;
+template class basicGameState<10, 40>;
+template class basicGameState<16, 20>;
+template class basicGameState<16, 40>;
+
+//Reads a board size written as the width and height separated by an x, such as 10x20
+//Throws when the text is not a size or the size is not one of boardSizes
+boardSize parseBoardSize(const std::string &text)
+{
+	boardSize size = {0, 0};
+	std::size_t split = text.find('x');
+	try
+	{
+		std::size_t used = 0;
+		size.width = std::stoi(text.substr(0, split), &used);
+		if (split == std::string::npos || used != split)
+		{
+			throw std::invalid_argument(text);
+		}
+		size.height = std::stoi(text.substr(split + 1), &used);
+		if (used != text.size() - split - 1)
+		{
+			throw std::invalid_argument(text);
+		}
+	}
+	catch (const std::logic_error &)
+	{
+		throw std::runtime_error("Board sizes are written as WIDTHxHEIGHT, not " + text);
+	}
+
+	for (const boardSize &supported : boardSizes)
+	{
+		if (supported.width == size.width && supported.height == size.height)
+		{
+			return size;
+		}
+	}
+	throw std::runtime_error("Unsupported board size " + text);
+}
+
+//Returns the points awarded for clearing a number of lines with one tetromino
+int scoreForLines(int lines)
+{
+	if (lines == 0)
+	{
+		//This will be true for the majority of the game so I am including it as the first of this if else-if change to save processing time
+		return 0;
+	}
+	else if (lines == 1)
+	{
+		return 40;
+	}
+	else if (lines == 2)
+	{
+		return 100;
+	}
+	else if (lines == 3)
+	{
+		return 300;
+	}
+	else if (lines == 4)
+	{
+		return 1200;
+	}
+
+	return 0;
+}
+
+//Returns the garbage rows a versus player sends an opponent for clearing a number of lines with one tetromino
+//Like the score it grows faster than the lines: a single sends nothing and a tetris four
+int garbageForLines(int lines)
+{
+	const int sent[5] = {0, 0, 1, 2, 4};
+	return lines >= 0 && lines <= 4 ? sent[lines] : 0;
+}
+
+/* Returns the garbage rows a clear sends, in the manner of the guideline versus tables
+Lines alone send 0, 1, 2 and 4 as garbageForLines; T-spin singles, doubles and triples send 2, 4 and 6 and mini
+T-spins 0, 1 and 2, a back-to-back tetris or T-spin clear one more, and clearing locks in a row add the combo
+table, which grows by one every two locks up to 5 */
+int attackForClear(int lines, tSpinType tSpin, bool backToBack, int combo)
+{
+	if (lines <= 0)
+	{
+		return 0;
+	}
+
+	const int tSpinAttack[4] = {0, 2, 4, 6};
+	const int miniAttack[4] = {0, 0, 1, 2};
+	const int comboAttack[12] = {0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 4, 5};
+	int capped = std::min(lines, 3);
+	int attack = tSpin == tSpinFull ? tSpinAttack[capped] : tSpin == tSpinMini ? miniAttack[capped] : garbageForLines(lines);
+	attack += backToBack ? 1 : 0;
+	attack += combo > 0 ? comboAttack[std::min(combo, 11)] : 0;
+	return attack;
+}
+
+//Mixes a base seed and a game index into the seed of that game
+unsigned gameSeed(std::uint64_t baseSeed, std::uint64_t index)
+{
+	//splitmix64 finalizer
+	std::uint64_t z = baseSeed + index * 0x9E3779B97F4A7C15ull;
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+	return unsigned(z ^ (z >> 31));
+}
+
+//Writes the rules of a game: the gravity table, the randomizer type, the preview length and the lock delay
+void writeRules(byteWriter &out, const gameRules &rules)
+{
+	out.writeBytes(rules.gravity.ticksPerRow, numLevels);
+	out.writeByte(rules.randomizer);
+	out.writeByte(std::max(0, std::min(rules.previewCount, maxPreviewLength)));
+	out.writeByte(std::max(0, std::min(rules.lockDelay, 255)));
+}
+
+//Reads rules written by writeRules
+gameRules readRules(byteReader &in)
+{
+	gameRules rules;
+	in.readBytes(rules.gravity.ticksPerRow, numLevels);
+	rules.randomizer = randomizerType(in.readByte());
+	rules.previewCount = in.readByte();
+	rules.lockDelay = in.readByte();
+	if (rules.randomizer >= numRandomizers || rules.previewCount > maxPreviewLength)
+	{
+		throw std::runtime_error("Invalid game rules");
+	}
+
+	return rules;
+}
+
+//Returns whether two sets of rules play the same game from the same seed
+bool sameRules(const gameRules &a, const gameRules &b)
+{
+	return std::equal(a.gravity.ticksPerRow, a.gravity.ticksPerRow + numLevels, b.gravity.ticksPerRow) && a.randomizer == b.randomizer && a.previewCount == b.previewCount && a.lockDelay == b.lockDelay;
+}
@@ -0,0 +1,234 @@
+#ifndef GAME_HPP
+#define GAME_HPP
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include "board.hpp"
+#include "randomizer.hpp"
+#include "serial.hpp"
+#include "tetromino.hpp"
+
+//Inputs applied to the active tetromino, combined as bit flags
+enum inputFlag : std::uint8_t
+{
+	inputNone = 0,
+	inputLeft = 1,
+	inputRight = 2,
+	inputRotate = 4,
+	inputDown = 8,
+	inputHold = 16,
+	inputHardDrop = 32,
+	inputRotateCcw = 64,
+	inputRotateHalf = 128
+};
+
+//Simulation steps per second; input, gravity and locking all advance in whole steps
+constexpr int ticksPerSecond = 60;
+constexpr int numLevels = 16;
+//Most upcoming tetrominos a game can draw ahead of the active one, so that players and the AI can see them
+constexpr int maxPreviewLength = 6;
+
+//Times moving or turning a tetromino off the stack restarts its lock delay before it reaches a lower row
+constexpr int maxLockResets = 15;
+
+//Most batches of incoming garbage a game queues; a batch past them is merged into the last one
+constexpr int maxGarbageBatches = 8;
+
+//Steps a tetromino waits before falling one row, for every level
+struct gravityTable
+{
+	std::uint8_t ticksPerRow[numLevels];
+};
+
+//Level 0 falls one row every 9 steps, the 150 ms the window used to sleep between rows
+constexpr gravityTable defaultGravity = {{9, 8, 7, 6, 5, 4, 4, 3, 3, 3, 2, 2, 2, 2, 2, 1}};
+
+//Settings a game is created with, fixed for the whole game
+struct gameRules
+{
+	gravityTable gravity = defaultGravity;
+	randomizerType randomizer = randomizerClassic;
+	//Tetrominos shown ahead of the active one, at most maxPreviewLength
+	int previewCount = 5;
+	//Steps a tetromino can rest on the stack, moving and turning, before it locks; at most 255
+	int lockDelay = 30;
+};
+
+//Keys pressed since the last simulation step
+struct input
+{
+	std::uint8_t flags = inputNone;
+	//Side moves past the first in the direction of inputLeft or inputRight, for auto repeat faster than one move a step
+	std::uint8_t repeats = 0;
+};
+
+//Kinds of T-spin a lock can be, found by the three corner rule
+enum tSpinType : std::uint8_t
+{
+	tSpinNone,
+	tSpinMini,
+	tSpinFull
+};
+
+//Garbage rows sent by one attack, all with their hole in the same column
+struct garbageBatch
+{
+	std::uint8_t rows;
+	std::uint8_t holeColumn;
+};
+
+//What happened during one simulation step
+struct stepResult
+{
+	bool locked = false;
+	bool lost = false;
+	int linesCleared = 0;
+	tSpinType tSpin = tSpinNone;
+	//Whether the clear followed another tetris or T-spin clear and earned the back-to-back bonus
+	bool backToBack = false;
+	//Clearing locks in a row before this one, -1 when this lock cleared nothing
+	int combo = -1;
+	//Garbage rows the clear sends to an opponent, after cancelling the ones queued for this game
+	int attack = 0;
+	//Garbage rows pushed into the board by a lock that cleared nothing
+	int garbageAdded = 0;
+};
+
+//Complete state of one game with no dependency on the window it is shown in
+//A step is one fixed length tick; once the level's gravity delay has passed it moves the active tetromino down one row,
+//locks it once it has rested on the stack for the lock delay, clears full rows and scores them; a hard drop lands and
+//locks it within the same step
+//The game is a template on the size of its board; the sizes listed in boardSizes are instantiated in game.cpp
+template <int setWidth, int setHeight>
+class basicGameState
+{
+	public:
+		typedef basicBoard<setWidth, setHeight> boardType;
+
+	private:
+		boardType field;
+		tetromino activeTet;
+		pieceRandomizer randomizer;
+		//Shapes of the next tetrominos, soonest first
+		int preview[maxPreviewLength];
+		int previewCount;
+		//Shape put aside by a hold, -1 while the slot is empty; only one hold is allowed per tetromino
+		int heldShape = -1;
+		bool holdUsed = false;
+		int score = 0;
+		int totalLines = 0;
+		int piecesPlaced = 0;
+		int level = 0;
+		int gravityCounter = 0;
+		//Steps the active tetromino has spent unable to fall
+		int groundedTicks = 0;
+		//Lowest row the active tetromino has reached, and the lock delay restarts it has used since reaching it
+		int lowestRow = 0;
+		int lockResets = 0;
+		//Whether the last thing that moved the active tetromino was a turn, and the kick that turn used, for T-spins
+		bool lastMoveTurned = false;
+		int lastKick = 0;
+		//Clearing locks in a row, -1 after a lock that cleared nothing
+		int combo = -1;
+		//Whether the last clear was a tetris or a T-spin, so that the next one of those earns the bonus
+		bool backToBack = false;
+		//Garbage sent by opponents and not cancelled yet, oldest first; it rises in when a lock clears nothing
+		garbageBatch incoming[maxGarbageBatches];
+		int incomingCount = 0;
+		gravityTable gravity;
+		int lockDelay;
+		bool gameOver = false;
+
+		int takeNextShape();
+		void turn(int direction);
+		tSpinType findTSpin() const;
+		int cancelGarbage(int attack);
+
+	public:
+		basicGameState(unsigned seed, const gameRules &rules = gameRules());
+
+		void applyInput(input in);
+		stepResult step(input in = input());
+		void restart();
+		void loadBoard(const boardType &startField);
+		void receiveGarbage(int rows, int holeColumn);
+		void save(byteWriter &out) const;
+		void load(byteReader &in);
+
+		const boardType &returnBoard() const;
+		const tetromino &returnActive() const;
+		tetromino returnGhost() const;
+		int returnPreview(int i) const;
+		int returnPreviewCount() const;
+		int returnHeld() const;
+		gameRules returnRules() const;
+		int returnScore() const;
+		int returnLines() const;
+		int returnPiecesPlaced() const;
+		int returnLevel() const;
+		bool isGameOver() const;
+		int returnPendingGarbage() const;
+		int returnCombo() const;
+		bool returnBackToBack() const;
+};
+
+//The game played on the standard board, which the window, the AI and replays use
+typedef basicGameState<numColumns, numRows> gameState;
+
+//Rollback copies whole games several times a frame, so the game has to stay one flat block that a copy moves with memcpy
+static_assert(std::is_trivially_copyable<gameState>::value, "The game state must be trivially copyable");
+static_assert(sizeof(gameState) <= 512, "The game state must stay within a few hundred bytes");
+
+//Width and height of a board in cells
+struct boardSize
+{
+	int width;
+	int height;
+};
+
+//Board sizes the game is instantiated for and can be chosen at runtime: the standard board, a tall one with a buffer
+//zone above it, and wide ones
+constexpr boardSize boardSizes[] = {{10, 20}, {10, 40}, {16, 20}, {16, 40}};
+
+//Calls a generic function with the width and height of a board size as std::integral_constant arguments, so that
+//the function can name basicGameState<width, height> and run fully specialized for that size
+//Throws when the size is not one of boardSizes
+template <class function>
+auto withBoardSize(boardSize size, function &&call)
+{
+	typedef std::integral_constant<int, 10> width10;
+	typedef std::integral_constant<int, 16> width16;
+	typedef std::integral_constant<int, 20> height20;
+	typedef std::integral_constant<int, 40> height40;
+	if (size.width == 10 && size.height == 20)
+	{
+		return call(width10(), height20());
+	}
+	else if (size.width == 10 && size.height == 40)
+	{
+		return call(width10(), height40());
+	}
+	else if (size.width == 16 && size.height == 20)
+	{
+		return call(width16(), height20());
+	}
+	else if (size.width == 16 && size.height == 40)
+	{
+		return call(width16(), height40());
+	}
+
+	throw std::runtime_error("Unsupported board size " + std::to_string(size.width) + "x" + std::to_string(size.height));
+}
+
+boardSize parseBoardSize(const std::string &text);
+int scoreForLines(int lines);
+int garbageForLines(int lines);
+int attackForClear(int lines, tSpinType tSpin, bool backToBack, int combo);
+void writeRules(byteWriter &out, const gameRules &rules);
+gameRules readRules(byteReader &in);
+bool sameRules(const gameRules &a, const gameRules &b);
+unsigned gameSeed(std::uint64_t baseSeed, std::uint64_t index);
+
+#endif
@@ -0,0 +1,135 @@
+#include <algorithm>
+#include "handling.hpp"
+
+//Constructor taking the DAS and ARR, with no keys held
+inputHandler::inputHandler(const handlingSettings &setSettings) : settings(setSettings)
+{
+}
+
+//Adds side moves toward a key to the step being built; a move the other way replaces the ones before it
+void inputHandler::addMoves(int key, std::int64_t moves)
+{
+	if (moves <= 0)
+	{
+		return;
+	}
+	if (stepShiftKey != key)
+	{
+		stepShiftKey = key;
+		stepMoves = 0;
+	}
+
+	//A move past the width of the board can never happen, so the count stays small whatever the ARR
+	stepMoves = int(std::min<std::int64_t>(stepMoves + moves, numColumns));
+}
+
+//Adds the repeats of the held side key that fall due before upTo
+void inputHandler::collectRepeats(std::int64_t upTo)
+{
+	if (shiftKey < 0)
+	{
+		return;
+	}
+
+	std::int64_t charged = upTo - chargeStart - settings.das.count();
+	if (charged <= 0)
+	{
+		return;
+	}
+
+	//With no repeat delay the held key keeps the tetromino against the wall, new tetrominos included
+	if (settings.arr.count() <= 0)
+	{
+		addMoves(shiftKey, numColumns);
+		return;
+	}
+
+	std::int64_t due = (charged - 1) / settings.arr.count() + 1;
+	if (due > repeatsGiven)
+	{
+		addMoves(shiftKey, due - repeatsGiven);
+		repeatsGiven = due;
+	}
+}
+
+//Applies one key event to the held keys and the input of the step being built
+void inputHandler::handle(const keyEvent &event, input &in)
+{
+	if (event.key >= numKeys || held[event.key] == event.pressed)
+	{
+		return;
+	}
+
+	held[event.key] = event.pressed;
+	if (event.key == keyLeft || event.key == keyRight)
+	{
+		//Repeats that fell due before the event still happen
+		collectRepeats(event.time);
+		int other = event.key == keyLeft ? keyRight : keyLeft;
+		if (event.pressed)
+		{
+			addMoves(event.key, 1);
+			shiftKey = event.key;
+			chargeStart = event.time;
+			repeatsGiven = 0;
+		}
+		else if (shiftKey == event.key)
+		{
+			shiftKey = held[other] ? other : -1;
+			chargeStart = event.time;
+			repeatsGiven = 0;
+		}
+		return;
+	}
+
+	if (!event.pressed)
+	{
+		return;
+	}
+
+	const std::uint8_t pressFlags[numKeys] = {inputNone, inputNone, inputDown, inputHardDrop, inputRotate, inputRotateCcw, inputRotateHalf, inputHold};
+	in.flags |= pressFlags[event.key];
+}
+
+//Returns the input of the step standing for the time up to stepEnd, taking the events stamped before it off the queue
+input inputHandler::nextStep(keyEventQueue &events, std::int64_t stepEnd)
+{
+	input in;
+	stepShiftKey = -1;
+	stepMoves = 0;
+
+	keyEvent event;
+	while (events.peek(event) && event.time < stepEnd)
+	{
+		events.pop(event);
+		handle(event, in);
+	}
+	collectRepeats(stepEnd);
+
+	//A held soft drop moves down every step
+	if (held[keySoftDrop])
+	{
+		in.flags |= inputDown;
+	}
+	if (stepMoves > 0)
+	{
+		in.flags |= stepShiftKey == keyLeft ? inputLeft : inputRight;
+		in.repeats = std::uint8_t(stepMoves - 1);
+	}
+
+	return in;
+}
+
+//Releases every key, for when the window stops seeing key events, such as while paused
+void inputHandler::reset()
+{
+	std::fill(held, held + numKeys, false);
+	shiftKey = -1;
+	repeatsGiven = 0;
+}
+
+//Returns the steady clock in nanoseconds, the time key events are stamped with
+std::int64_t timestampNow()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
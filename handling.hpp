@@ -0,0 +1,78 @@
+#ifndef HANDLING_HPP
+#define HANDLING_HPP
+
+#include <chrono>
+#include <cstdint>
+#include "game.hpp"
+#include "inputQueue.hpp"
+
+//Keys a player holds down, as the window maps them
+enum inputKey : std::uint8_t
+{
+	keyLeft,
+	keyRight,
+	keySoftDrop,
+	keyHardDrop,
+	keyRotate,
+	keyRotateCcw,
+	keyRotateHalf,
+	keyHold,
+	numKeys
+};
+
+//A key going down or up, stamped with the steady clock in nanoseconds as soon as the window receives it
+struct keyEvent
+{
+	std::int64_t time;
+	std::uint8_t key;
+	bool pressed;
+};
+
+//Key events on their way from the window's event loop to the simulation steps
+typedef spscRing<keyEvent, 256> keyEventQueue;
+
+//How a held side key repeats
+struct handlingSettings
+{
+	//Delayed auto shift: time a side key is held after its first move before it starts repeating
+	std::chrono::nanoseconds das = std::chrono::milliseconds(133);
+	//Auto repeat rate: time between repeated moves once repeating; 0 moves straight to the wall
+	std::chrono::nanoseconds arr = std::chrono::milliseconds(33);
+};
+
+/* Turns timestamped key events into the input of each simulation step
+A step takes every event stamped before the end of the time it stands for, in order, so a key press counts from
+when it happened rather than from when the step ran. A side key moves once when pressed and, once held for the
+DAS, again every ARR after that; the repeats due before each event and before the end of the step are counted
+from the press time, so they do not drift with the step length. The later of two held side keys wins, and
+releasing it hands over to the other one, which charges its DAS again from the release
+Only the resulting step inputs reach the game, so replays record them and play back the same on any system */
+class inputHandler
+{
+	private:
+		handlingSettings settings;
+		bool held[numKeys] = {};
+		//Side key charging or repeating, -1 while neither is held
+		int shiftKey = -1;
+		std::int64_t chargeStart = 0;
+		//Repeated moves given since chargeStart
+		std::int64_t repeatsGiven = 0;
+
+		//Side moves of the step being built and the key they go toward
+		int stepShiftKey = -1;
+		int stepMoves = 0;
+
+		void addMoves(int key, std::int64_t moves);
+		void collectRepeats(std::int64_t upTo);
+		void handle(const keyEvent &event, input &in);
+
+	public:
+		inputHandler(const handlingSettings &setSettings = handlingSettings());
+
+		input nextStep(keyEventQueue &events, std::int64_t stepEnd);
+		void reset();
+};
+
+std::int64_t timestampNow();
+
+#endif
@@ -0,0 +1,61 @@
+#ifndef INPUT_QUEUE_HPP
+#define INPUT_QUEUE_HPP
+
+#include <atomic>
+#include <cstddef>
+
+//Bounded queue between one producer thread and one consumer thread that never locks or allocates
+//The producer only writes the tail and the consumer only writes the head, each on its own cache line,
+//so a push and a pop never wait on each other; capacity must be a power of two
+template <typename T, std::size_t capacity>
+class spscRing
+{
+	private:
+		static_assert(capacity > 0 && (capacity & (capacity - 1)) == 0, "Capacity must be a power of two");
+
+		T items[capacity];
+		alignas(64) std::atomic<std::size_t> head{0};
+		alignas(64) std::atomic<std::size_t> tail{0};
+
+	public:
+		//Adds an item at the back, returning false without adding it when the queue is full
+		bool push(const T &item)
+		{
+			std::size_t back = tail.load(std::memory_order_relaxed);
+			if (back - head.load(std::memory_order_acquire) == capacity)
+			{
+				return false;
+			}
+
+			items[back & (capacity - 1)] = item;
+			tail.store(back + 1, std::memory_order_release);
+			return true;
+		}
+
+		//Copies the item at the front without removing it, returning false when the queue is empty
+		bool peek(T &item) const
+		{
+			std::size_t front = head.load(std::memory_order_relaxed);
+			if (front == tail.load(std::memory_order_acquire))
+			{
+				return false;
+			}
+
+			item = items[front & (capacity - 1)];
+			return true;
+		}
+
+		//Removes the item at the front, returning false when the queue is empty
+		bool pop(T &item)
+		{
+			if (!peek(item))
+			{
+				return false;
+			}
+
+			head.store(head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+			return true;
+		}
+};
+
+#endif
@@ -0,0 +1,225 @@
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+#include "instrument.hpp"
+
+counterBank globalCounters;
+thread_local frameProfiler *activeProfiler = nullptr;
+
+//Returns the bucket counting a value: values below subBuckets exactly, larger ones by their top subBucketBits + 1 bits
+int latencyHistogram::bucketFor(std::uint64_t value)
+{
+	if (value < subBuckets)
+	{
+		return int(value);
+	}
+
+#if defined(__GNUC__) || defined(__clang__)
+	int exponent = 63 - __builtin_clzll(value);
+#else
+	int exponent = 0;
+	while (value >> (exponent + 1))
+	{
+		exponent++;
+	}
+#endif
+	int sub = int(value >> (exponent - subBucketBits)) & (subBuckets - 1);
+	return (exponent - subBucketBits + 1) * subBuckets + sub;
+}
+
+//Returns the largest value a bucket counts
+std::uint64_t latencyHistogram::bucketTop(int bucket)
+{
+	if (bucket < subBuckets)
+	{
+		return bucket;
+	}
+
+	int exponent = bucket / subBuckets + subBucketBits - 1;
+	std::uint64_t width = std::uint64_t(1) << (exponent - subBucketBits);
+	return (std::uint64_t(subBuckets + bucket % subBuckets) << (exponent - subBucketBits)) + width - 1;
+}
+
+//Counts one value
+void latencyHistogram::record(std::uint64_t value)
+{
+	counts[bucketFor(value)]++;
+	count++;
+	maxValue = std::max(maxValue, value);
+	sum += value;
+}
+
+//Adds the values counted by another histogram, such as another thread's
+void latencyHistogram::merge(const latencyHistogram &other)
+{
+	for (int i = 0; i < numBuckets; i++)
+	{
+		counts[i] += other.counts[i];
+	}
+	count += other.count;
+	maxValue = std::max(maxValue, other.maxValue);
+	sum += other.sum;
+}
+
+//Forgets every value counted so far
+void latencyHistogram::clear()
+{
+	std::fill(counts, counts + numBuckets, 0);
+	count = 0;
+	maxValue = 0;
+	sum = 0;
+}
+
+//Returns how many values were counted
+std::uint64_t latencyHistogram::returnCount() const
+{
+	return count;
+}
+
+//Returns the largest value counted, exactly
+std::uint64_t latencyHistogram::returnMax() const
+{
+	return maxValue;
+}
+
+//Returns the mean of the values counted, exactly
+double latencyHistogram::returnMean() const
+{
+	return count ? sum / count : 0;
+}
+
+//Returns a value at least as large as the given fraction of the values counted, within the error of its bucket
+std::uint64_t latencyHistogram::returnPercentile(double fraction) const
+{
+	if (count == 0)
+	{
+		return 0;
+	}
+
+	std::uint64_t rank = std::max<std::uint64_t>(1, std::uint64_t(fraction * count + 0.5));
+	std::uint64_t seen = 0;
+	for (int i = 0; i < numBuckets; i++)
+	{
+		seen += counts[i];
+		if (seen >= rank)
+		{
+			return std::min(bucketTop(i), maxValue);
+		}
+	}
+
+	return maxValue;
+}
+
+//Adds to a counter on the calling thread's stripe
+void counterBank::add(int counter, std::uint64_t amount)
+{
+	thread_local int stripeIndex = -1;
+	if (stripeIndex < 0)
+	{
+		stripeIndex = nextStripe.fetch_add(1, std::memory_order_relaxed) % numStripes;
+	}
+
+	//Only threads sharing a stripe ever write the same value, so the add rarely contends
+	stripes[stripeIndex].values[counter].fetch_add(amount, std::memory_order_relaxed);
+}
+
+//Returns a counter added up over every stripe; counts still being added may or may not be included
+std::uint64_t counterBank::returnTotal(int counter) const
+{
+	std::uint64_t total = 0;
+	for (int i = 0; i < numStripes; i++)
+	{
+		total += stripes[i].values[counter].load(std::memory_order_relaxed);
+	}
+	return total;
+}
+
+//Counts one duration of a phase
+void frameProfiler::record(int phase, std::chrono::nanoseconds duration)
+{
+	std::uint64_t value = std::max<std::int64_t>(0, duration.count());
+	phases[phase].record(value);
+	recent[phase].record(value);
+}
+
+//Forgets the recent durations, starting a new window of them
+void frameProfiler::startRecent()
+{
+	for (int phase = 0; phase < numPhases; phase++)
+	{
+		recent[phase].clear();
+	}
+}
+
+//Returns the durations counted for a phase over the whole run
+const latencyHistogram &frameProfiler::returnPhase(int phase) const
+{
+	return phases[phase];
+}
+
+//Returns the durations counted for a phase since the recent window started
+const latencyHistogram &frameProfiler::returnRecent(int phase) const
+{
+	return recent[phase];
+}
+
+//Returns a one line summary of the recent median and 99th percentile of the frame and each of its phases, in milliseconds
+std::string frameProfiler::summary() const
+{
+	std::ostringstream out;
+	out << std::fixed << std::setprecision(2);
+	for (int phase = 0; phase < numPhases; phase++)
+	{
+		const latencyHistogram &timings = recent[numPhases - 1 - phase];
+		out << (phase ? " | " : "") << phaseName(numPhases - 1 - phase) << " " << timings.returnPercentile(0.5) / 1e6 << "/" << timings.returnPercentile(0.99) / 1e6;
+	}
+	out << " ms";
+	return out.str();
+}
+
+//Writes the distribution of every phase in microseconds and the total of every counter
+void frameProfiler::writeReport(std::ostream &out) const
+{
+	out << std::fixed << std::setprecision(1);
+	out << std::left << std::setw(12) << "phase" << std::right << std::setw(10) << "count" << std::setw(10) << "mean_us" << std::setw(10) << "p50_us" << std::setw(10) << "p90_us" << std::setw(10) << "p99_us" << std::setw(10) << "p999_us" << std::setw(10) << "max_us" << "\n";
+	for (int phase = 0; phase < numPhases; phase++)
+	{
+		const latencyHistogram &timings = phases[phase];
+		out << std::left << std::setw(12) << phaseName(phase) << std::right << std::setw(10) << timings.returnCount() << std::setw(10) << timings.returnMean() / 1e3;
+		out << std::setw(10) << timings.returnPercentile(0.5) / 1e3 << std::setw(10) << timings.returnPercentile(0.9) / 1e3 << std::setw(10) << timings.returnPercentile(0.99) / 1e3;
+		out << std::setw(10) << timings.returnPercentile(0.999) / 1e3 << std::setw(10) << timings.returnMax() / 1e3 << "\n";
+	}
+
+	out << "\n" << std::left << std::setw(12) << "counter" << std::right << std::setw(10) << "total" << "\n";
+	for (int counter = 0; counter < numCounters; counter++)
+	{
+		out << std::left << std::setw(12) << counterName(counter) << std::right << std::setw(10) << globalCounters.returnTotal(counter) << "\n";
+	}
+}
+
+//Writes the report to a text file
+void frameProfiler::saveToFile(const std::string &path) const
+{
+	std::ofstream file(path, std::ios::trunc);
+	writeReport(file);
+	if (!file)
+	{
+		throw std::runtime_error("Could not write " + path);
+	}
+}
+
+//Returns the name a phase is reported under
+const char *phaseName(int phase)
+{
+	const char *names[numPhases] = {"input", "simulation", "lineClear", "cellMap", "draw", "frame"};
+	return phase >= 0 && phase < numPhases ? names[phase] : "unknown";
+}
+
+//Returns the name a counter is reported under
+const char *counterName(int counter)
+{
+	const char *names[numCounters] = {"frames", "steps", "locks", "lines", "keyEvents", "searchNodes"};
+	return counter >= 0 && counter < numCounters ? names[counter] : "unknown";
+}
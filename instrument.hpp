@@ -0,0 +1,139 @@
+#ifndef INSTRUMENT_HPP
+#define INSTRUMENT_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+//Parts of a frame of the window that are timed; line clears happen inside simulation steps
+enum timedPhase : int
+{
+	phaseInput,
+	phaseSimulation,
+	phaseLineClear,
+	phaseCellMap,
+	phaseDraw,
+	phaseFrame,
+	numPhases
+};
+
+//Events counted across every thread
+enum statCounter : int
+{
+	counterFrames,
+	counterSteps,
+	counterLocks,
+	counterLines,
+	counterKeyEvents,
+	counterSearchNodes,
+	numCounters
+};
+
+/* Histogram of durations in nanoseconds with a bounded relative error, in the manner of HDR histograms
+Durations below 16 ns get a bucket each; above that every power of two is split into 16 buckets, so a duration is
+counted within 1/16 of its value whatever its size, in a fixed table that recording never grows */
+class latencyHistogram
+{
+	private:
+		static constexpr int subBucketBits = 4;
+		static constexpr int subBuckets = 1 << subBucketBits;
+		static constexpr int numBuckets = (64 - subBucketBits + 1) * subBuckets;
+
+		std::uint64_t counts[numBuckets] = {};
+		std::uint64_t count = 0;
+		std::uint64_t maxValue = 0;
+		double sum = 0;
+
+		static int bucketFor(std::uint64_t value);
+		static std::uint64_t bucketTop(int bucket);
+
+	public:
+		void record(std::uint64_t value);
+		void merge(const latencyHistogram &other);
+		void clear();
+
+		std::uint64_t returnCount() const;
+		std::uint64_t returnMax() const;
+		double returnMean() const;
+		std::uint64_t returnPercentile(double fraction) const;
+};
+
+//Event counters any thread can add to without locking or sharing a cache line with another thread
+//Threads are spread over stripes of counters as they first count something, and totals add the stripes up
+class counterBank
+{
+	private:
+		static constexpr int numStripes = 64;
+
+		struct alignas(64) stripe
+		{
+			std::atomic<std::uint64_t> values[numCounters];
+		};
+
+		stripe stripes[numStripes] = {};
+		std::atomic<int> nextStripe{0};
+
+	public:
+		void add(int counter, std::uint64_t amount = 1);
+		std::uint64_t returnTotal(int counter) const;
+};
+
+//Counters of the whole process
+extern counterBank globalCounters;
+
+//Timings of the phases of every frame shown in one window, recorded by the thread running the window
+//Besides the whole run, the timings since the last call to startRecent are kept for showing live
+class frameProfiler
+{
+	private:
+		latencyHistogram phases[numPhases];
+		latencyHistogram recent[numPhases];
+
+	public:
+		void record(int phase, std::chrono::nanoseconds duration);
+		void startRecent();
+		const latencyHistogram &returnPhase(int phase) const;
+		const latencyHistogram &returnRecent(int phase) const;
+		std::string summary() const;
+		void writeReport(std::ostream &out) const;
+		void saveToFile(const std::string &path) const;
+};
+
+//Profiler the scoped timers of the calling thread record into; null leaves them idle
+extern thread_local frameProfiler *activeProfiler;
+
+//Times its own lifetime into a phase of the calling thread's active profiler, doing nothing when there is none
+class scopedTimer
+{
+	private:
+		frameProfiler *profiler;
+		int phase;
+		std::chrono::steady_clock::time_point start;
+
+	public:
+		scopedTimer(int setPhase) : profiler(activeProfiler), phase(setPhase)
+		{
+			if (profiler)
+			{
+				start = std::chrono::steady_clock::now();
+			}
+		}
+
+		~scopedTimer()
+		{
+			if (profiler)
+			{
+				profiler->record(phase, std::chrono::steady_clock::now() - start);
+			}
+		}
+
+		scopedTimer(const scopedTimer &) = delete;
+		scopedTimer &operator=(const scopedTimer &) = delete;
+};
+
+const char *phaseName(int phase);
+const char *counterName(int counter);
+
+#endif
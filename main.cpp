@@ -1,961 +1,396 @@
+#include <algorithm>
 #include <iostream>
+#include <memory>
 #include <random>
-#include <thread>
 #include <chrono>
+#include <cmath>
+#include <stdexcept>
+#include <string>
 #include <SFML/Graphics.hpp>
+#include "ai.hpp"
+#include "game.hpp"
+#include "handling.hpp"
+#include "instrument.hpp"
+#include "renderer.hpp"
+#include "replay.hpp"
+#include "spectator.hpp"
 
 constexpr int cellLength = 40;
 constexpr int lineWidth = 1;
-constexpr int numColumns = 10;
-constexpr int numRows = 20;
 constexpr int padding = 80;
+//Cells of the preview and hold tetrominos drawn in the padding beside the board
+constexpr int sideCellLength = 16;
 constexpr int windowX = 2*padding + numColumns*cellLength;
 constexpr int windowY = 2*padding + numRows*cellLength;
+const std::string windowTitle = "Tetris Clone";
 
-//Structure representing a (x, y) coordinate pair/
-struct position
+//Returns the key a keyboard key is bound to, or numKeys when it is not bound to one
+int keyFor(sf::Keyboard::Key code)
 {
-	int x, y;
-};
-
-//Cells used to compose a cell map making up the game board
-//Can be filled or unfilled with an arbitrary color
-class cell
-{
-	private:
-		position p;
-		bool isFilled = false;
-		sf::RectangleShape lines[4];
-		sf::RectangleShape fill;
-
-	public:
-		cell(int x, int y);
-		void configLines();
-		void configFill(sf::Color fillColor);
-		void setIsFilled(bool set);
-		bool returnIsFilled();
-		sf::RectangleShape returnLine(int d);
-		sf::RectangleShape returnFill();
-};
-
-//Consturctor initializing the cells position in the cell map and calling the function that configures the cell's borders
-cell::cell(int x, int y)
-{
-	p.x = x;
-	p.y = y;
-	configLines();
-}
-
-//Configures the cell's borders into SFML rectangles
-void cell::configLines()
-{
-	for (int i = 0; i < 4; i++)
+	switch (code)
 	{
-		lines[i].setSize(sf::Vector2f(cellLength, lineWidth));
-		lines[i].setFillColor(sf::Color::White);
-		if (i == 0 || i == 1)
-		{
-			lines[i].setPosition((p.x * cellLength + padding), (p.y * cellLength + padding));
-		}
-		if (i == 1 || i == 3)
-		{
-			lines[i].setRotation(90.f);
-		}
+		case sf::Keyboard::Left:
+			return keyLeft;
+		case sf::Keyboard::Right:
+			return keyRight;
+		case sf::Keyboard::Down:
+			return keySoftDrop;
+		case sf::Keyboard::Enter:
+			return keyHardDrop;
+		case sf::Keyboard::Up:
+			return keyRotate;
+		case sf::Keyboard::Z:
+			return keyRotateCcw;
+		case sf::Keyboard::A:
+			return keyRotateHalf;
+		case sf::Keyboard::C:
+		case sf::Keyboard::LShift:
+			return keyHold;
+		default:
+			return numKeys;
 	}
-
-	lines[2].setPosition((p.x * cellLength + padding), ((p.y + 1) * cellLength + padding));
-
-	lines[3].setPosition(((p.x + 1) * cellLength + padding), (p.y * cellLength + padding));
 }
 
-//Configures the cell's fill into a SFML rectangle of arbitrary length
-void cell::configFill (sf::Color fillColor)
+//Options of the game binary
+struct gameOptions
 {
-	fill.setSize(sf::Vector2f(cellLength, cellLength));
-	fill.setFillColor(fillColor);
-	fill.setPosition((p.x * cellLength + padding), (p.y * cellLength + padding));
-}
-
-//Returns the SFML rectangle of the cell's line at direction d
-//0 is up, 1 is left, 2 is down, 3 is right
-sf::RectangleShape cell::returnLine(int d)
-{
-	return lines[d];
-}
-
-//Returns the SFML rectanlge of the cell's fill
-sf::RectangleShape cell::returnFill()
-{
-	return fill;
-}
-
-//Sets whether or not the fill should be displayed
-void cell::setIsFilled(bool set)
-{
-	isFilled = set;
-}
-
-//Returns whether or not the fill should eb displayed
-bool cell::returnIsFilled()
-{
-	return isFilled;
-}
-
-//Blocks that represent each filled cell on the map
-class block
-{
-	private:
-		position p;
-		//Default color of white
-		sf::Color blockColor = sf::Color::White;
-	public:
-		void move(int dir);
-		//Set position must be called
-		void setPosition(int x, int y);
-		position returnPosition();
-		void setColor(sf::Color color);
-		sf::Color returnColor();
+	//Shows this many headless games instead of a playable one when above 0
+	int spectateBoards = 0;
+	policyType policy = policyRandom;
+	unsigned seed = 0;
+	bool hasSeed = false;
+	//Frame limit of the window, vertical sync is used when it is 0
+	int frameLimit = 0;
+	//Replay file written when the window closes, nothing is recorded when empty
+	std::string recordPath;
+	//Frame timing report written when the window closes, nothing is written when empty
+	std::string statsPath;
+	//Lets the AI play the game in the window instead of the keyboard
+	bool autoplay = false;
+	gameRules rules;
+	handlingSettings handling;
+	//Search settings of the AI; in the window it gets a time budget so that a move never holds up a frame for long
+	aiOptions ai;
 };
 
-//Function to move a block in an arbitrary direction
-//0 is up, 1 is left, 2 is down, 3 is right
-void block::move(int dir)
-{
-	if (dir == 0)
-	{
-		p.y--;
-	}
-	else if (dir == 1)
-	{
-		p.x--;
-	}
-	else if (dir == 2)
-	{
-		p.y++;
-	}
-	else if (dir == 3)
-	{
-		p.x++;
-	}
-}
-
-//Sets a blocks position to an arbitrary point
-void block::setPosition(int x, int y)
-{
-	p.x = x;
-	p.y = y;
-}
-
-//Returns a block's position object
-position block::returnPosition()
-{
-	return p;
-}
-
-//Sets a blocks color to an arbitrary value
-void block::setColor(sf::Color color)
-{
-	blockColor = color;
-}
-
-//Returns a block's color
-sf::Color block::returnColor()
-{
-	return blockColor;
-}
-
-//Tetrominos are groups of blocks
-class tetromino
-{
-	private:
-		// Block list making up ithe tetromino
-		std::vector<block> blockList;
-		position p;
-		/* Shape IDs
-		0: I
-		1: O
-		2: T
-		3: J
-		4: L
-		5: S
-		6: Z */
-		int shape;
-		/* Rotation values
-		0: 0 degrees
-		1: 90 degrees
-		2: 180 degrees
-		3: 270 degrees */
-		int rotation;
-
-	public:
-		tetromino(int setShape);
-		
-		/* Move directions
-		0: Up
-		1: Left
-		2: Down
-		3: Right */
-		void move(int direction);
-		position returnPosition();
-		/* Rotate directions
-		-1: Counter-clockwise
-		1: Clockwise */
-		void rotate(int direction);
-		
-		std::vector<block> decompose(std::vector<block> setBlockList);
-
-		void configBlockList();
-		std::vector<block> returnBlockList();
-};
-
-//Constructor setting the shape ID, the x and y coordinates, and the default blockList values
-tetromino::tetromino(int setShape)
-{
-	shape = setShape;
-	p.x = numColumns/2;
-	p.y = 0;
-	rotation = 0;
-	configBlockList();
-}
-
-//Move a whole tetromino in an arbitrary direction
-//0: Up, 1: Left, 2: Down, 3: Right
-void tetromino::move(int direction)
-{
-	try
-	{
-		if (direction < 0 || direction > 3)
-		{
-			throw std::runtime_error("Move direction out of bounds");
-		}
-
-		if (direction == 0)
-		{
-			p.y--;
-		}
-		else if (direction == 1)
-		{
-			p.x--;
-		}
-		else if (direction == 2)
-		{
-			p.y++;
-		}
-		else
-		{
-			p.x++;
-		}
-	}
-	catch(std::exception const &e)
-	{
-		std::cerr << "Exception: " << e.what() << "\n";
-	}
-}
-
-//Return the position of the tetromino
-position tetromino::returnPosition()
-{
-	return p;
-}
-//Rotate a whole tetromino in an arbitrary direction
-//-1: Counter-clockwise, 1: Clockwise
-void tetromino::rotate(int direction)
+//Reads the options from the command line
+gameOptions parseOptions(int argc, char **argv)
 {
-	try
+	gameOptions options;
+	options.ai.lookahead = 2;
+	options.ai.timeBudget = std::chrono::milliseconds(8);
+	for (int i = 1; i < argc; i++)
 	{
-		if (direction != -1 && direction != 1)
+		std::string arg = argv[i];
+		if (arg == "--ai")
 		{
-			throw std::runtime_error("Rotation direction out of bounds");
+			options.autoplay = true;
+			continue;
 		}
-
-		rotation += direction;
-		rotation %= 4;
-	}
-	catch(std::exception const &e)
-	{
-		std::cerr << "Exception: " << e.what() << "\n";
-	}
-}
-
-//Returns an augmented block list where the give tetromino has decomposed to the blocks that make it up
-std::vector<block> tetromino::decompose(std::vector<block> setBlockList)
-{
-	for (int i = 0; i < blockList.size(); i++)
-	{
-		block tempBlock = blockList[i];
-		tempBlock.setPosition(blockList[i].returnPosition().x + p.x, blockList[i].returnPosition().y + p.y);
-		setBlockList.push_back(tempBlock);
-	}
-
-	return setBlockList;
-}
-
-//Configures the whole block list of this tetromino
-void tetromino::configBlockList()
-{
-	/* Tetromino Shapes:
-	0 - I
-	1 - O
-	2 - T
-	3 - J
-	4 - L
-	5 - S
-	6 - Z */
-
-	/* Rotation IDs:
-	0 - 0   degrees
-	1 - 90  degrees
-	2 - 180 degrees
-	3 - 270 degrees */
-
-	//Four blocks for each tetromino
-	block blocks[4];
-
-	//I
-	if (shape == 0)
-	{
-		if (rotation == 0)
-		{
-			blocks[0].setPosition(-1,  0);
-			blocks[1].setPosition( 0,  0);
-			blocks[2].setPosition( 1,  0);
-			blocks[3].setPosition( 2,  0);
-		}
-		else if (rotation == 1)
-		{
-			blocks[0].setPosition( 0, -1);
-			blocks[1].setPosition( 0,  0);
-			blocks[2].setPosition( 0,  1);
-			blocks[3].setPosition( 0,  2);
-		}
-		else if (rotation == 2)
+		if (i + 1 >= argc)
 		{
-			blocks[0].setPosition(-2,  0);
-			blocks[1].setPosition(-1,  0);
-			blocks[2].setPosition( 0,  0);
-			blocks[3].setPosition( 1,  0);
-		}
-		else if (rotation == 3)
-		{
-			blocks[0].setPosition( 0, -2);
-			blocks[1].setPosition( 0, -1);
-			blocks[2].setPosition( 0,  0);
-			blocks[3].setPosition( 0,  1);
+			throw std::runtime_error("Missing value for " + arg);
 		}
 
-		blocks[0].setColor(sf::Color::Cyan);
-		blocks[1].setColor(sf::Color::Cyan);
-		blocks[2].setColor(sf::Color::Cyan);
-		blocks[3].setColor(sf::Color::Cyan);
-	}
-	//O
-	else if (shape == 1)
-	{
-		if (rotation == 0)
+		std::string value = argv[++i];
+		if (arg == "--spectate")
 		{
-			blocks[0].setPosition( 0,  0);
-			blocks[1].setPosition( 1,  0);
-			blocks[2].setPosition( 0,  1);
-			blocks[3].setPosition( 1,  1);
+			options.spectateBoards = std::stoi(value);
 		}
-		else if (rotation == 1)
+		else if (arg == "--policy")
 		{
-			blocks[0].setPosition(-1,  0);
-			blocks[1].setPosition( 0,  0);
-			blocks[2].setPosition(-1,  1);
-			blocks[3].setPosition( 0,  1);
+			options.policy = parsePolicy(value);
 		}
-		else if (rotation == 2)
+		else if (arg == "--seed")
 		{
-			blocks[0].setPosition(-1, -1);
-			blocks[1].setPosition( 0, -1);
-			blocks[2].setPosition(-1,  0);
-			blocks[3].setPosition( 0,  0);
+			options.seed = std::stoul(value);
+			options.hasSeed = true;
 		}
-		else if (rotation == 3)
+		else if (arg == "--fps")
 		{
-			blocks[0].setPosition( 0, -1);
-			blocks[1].setPosition( 1, -1);
-			blocks[2].setPosition( 0,  0);
-			blocks[3].setPosition( 1,  0);
+			options.frameLimit = std::stoi(value);
 		}
-
-		blocks[0].setColor(sf::Color::Yellow);
-		blocks[1].setColor(sf::Color::Yellow);
-		blocks[2].setColor(sf::Color::Yellow);
-		blocks[3].setColor(sf::Color::Yellow);
-	}
-	//T
-	else if (shape == 2)
-	{
-		if (rotation == 0)
-		{
-			blocks[0].setPosition( 0, -1);
-			blocks[1].setPosition( 0,  0);
-			blocks[2].setPosition( 1,  0);
-			blocks[3].setPosition( 0,  1);
-		}
-		else if (rotation == 1)
-		{
-			blocks[0].setPosition(-1,  0);
-			blocks[1].setPosition( 0,  0);
-			blocks[2].setPosition( 1,  0);
-			blocks[3].setPosition( 0,  1);
-		}
-		else if (rotation == 2)
-		{
-			blocks[0].setPosition( 0, -1);
-			blocks[1].setPosition( 0,  0);
-			blocks[2].setPosition(-1,  0);
-			blocks[3].setPosition( 0,  1);
-		}
-		else if (rotation == 3)
-		{
-			blocks[0].setPosition( 0, -1);
-			blocks[1].setPosition(-1,  0);
-			blocks[2].setPosition( 0,  0);
-			blocks[3].setPosition( 1,  0);
-		}
-
-		blocks[0].setColor(sf::Color::Magenta);
-		blocks[1].setColor(sf::Color::Magenta);
-		blocks[2].setColor(sf::Color::Magenta);
-		blocks[3].setColor(sf::Color::Magenta);
-	}
-	//J
-	else if (shape == 3)
-	{
-		if (rotation == 0)
-		{
-			blocks[0].setPosition( 0, -1);
-			blocks[1].setPosition( 0,  0);
-			blocks[2].setPosition( 0,  1);
-			blocks[3].setPosition(-1,  1);
-		}
-		else if (rotation == 1)
-		{
-			blocks[0].setPosition(-1, -1);
-			blocks[1].setPosition(-1,  0);
-			blocks[2].setPosition( 0,  0);
-			blocks[3].setPosition( 1,  0);
-		}
-		else if (rotation == 2)
-		{
-			blocks[0].setPosition( 0, -1);
-			blocks[1].setPosition( 1, -1);
-			blocks[2].setPosition( 0,  0);
-			blocks[3].setPosition( 0,  1);
-		}
-		else if (rotation == 3)
+		else if (arg == "--record")
 		{
-			blocks[0].setPosition(-1,  0);
-			blocks[1].setPosition( 0,  0);
-			blocks[2].setPosition( 1,  0);
-			blocks[3].setPosition( 1,  1);
+			options.recordPath = value;
 		}
-
-		blocks[0].setColor(sf::Color::Blue);
-		blocks[1].setColor(sf::Color::Blue);
-		blocks[2].setColor(sf::Color::Blue);
-		blocks[3].setColor(sf::Color::Blue);
-	}
-	//L
-	else if (shape == 4)
-	{
-		if (rotation == 0)
+		else if (arg == "--stats")
 		{
-			blocks[0].setPosition( 0, -1);
-			blocks[1].setPosition( 0,  0);
-			blocks[2].setPosition( 0,  1);
-			blocks[3].setPosition( 1,  1);
+			options.statsPath = value;
 		}
-		else if (rotation == 1)
+		else if (arg == "--randomizer")
 		{
-			blocks[0].setPosition(-1,  0);
-			blocks[1].setPosition( 0,  0);
-			blocks[2].setPosition( 1,  0);
-			blocks[3].setPosition(-1,  1);
+			options.rules.randomizer = parseRandomizer(value);
 		}
-		else if (rotation == 2)
+		else if (arg == "--preview")
 		{
-			blocks[0].setPosition(-1, -1);
-			blocks[1].setPosition( 0, -1);
-			blocks[2].setPosition( 0,  0);
-			blocks[3].setPosition( 0,  1);
+			options.rules.previewCount = std::stoi(value);
 		}
-		else if (rotation == 3)
+		else if (arg == "--lock-delay")
 		{
-			blocks[0].setPosition( 1, -1);
-			blocks[1].setPosition(-1,  0);
-			blocks[2].setPosition( 0,  0);
-			blocks[3].setPosition( 1,  0);
+			options.rules.lockDelay = std::stoi(value);
 		}
-
-		blocks[0].setColor(sf::Color::White);
-		blocks[1].setColor(sf::Color::White);
-		blocks[2].setColor(sf::Color::White);
-		blocks[3].setColor(sf::Color::White);
-	}
-	//S
-	else if (shape == 5)
-	{
-		if (rotation == 0)
+		else if (arg == "--das")
 		{
-			blocks[0].setPosition( 0, -1);
-			blocks[1].setPosition( 0,  0);
-			blocks[2].setPosition( 1,  0);
-			blocks[3].setPosition( 1,  1);
+			options.handling.das = std::chrono::microseconds(std::llround(std::stod(value) * 1000));
 		}
-		else if (rotation == 1)
+		else if (arg == "--arr")
 		{
-			blocks[0].setPosition( 0,  0);
-			blocks[1].setPosition( 1,  0);
-			blocks[2].setPosition(-1,  1);
-			blocks[3].setPosition( 0,  1);
+			options.handling.arr = std::chrono::microseconds(std::llround(std::stod(value) * 1000));
 		}
-		else if (rotation == 2)
+		else if (arg == "--lookahead")
 		{
-			blocks[0].setPosition(-1, -1);
-			blocks[1].setPosition(-1,  0);
-			blocks[2].setPosition( 0,  0);
-			blocks[3].setPosition( 0,  1);
+			options.ai.lookahead = std::stoi(value);
 		}
-		else if (rotation == 3)
+		else if (arg == "--budget")
 		{
-			blocks[0].setPosition( 0, -1);
-			blocks[1].setPosition( 1, -1);
-			blocks[2].setPosition(-1,  0);
-			blocks[3].setPosition( 0,  0);
+			options.ai.timeBudget = std::chrono::microseconds(std::llround(std::stod(value) * 1000));
 		}
-
-		blocks[0].setColor(sf::Color::Green);
-		blocks[1].setColor(sf::Color::Green);
-		blocks[2].setColor(sf::Color::Green);
-		blocks[3].setColor(sf::Color::Green);
-	}
-	//Z
-	else if (shape == 6)
-	{
-		if (rotation == 0)
+		else if (arg == "--weights")
 		{
-			blocks[0].setPosition( 1, -1);
-			blocks[1].setPosition( 0,  0);
-			blocks[2].setPosition( 1,  0);
-			blocks[3].setPosition( 0,  1);
+			options.ai.weights = parseWeights(value);
 		}
-		else if (rotation == 1)
-		{
-			blocks[0].setPosition(-1,  0);
-			blocks[1].setPosition( 0,  0);
-			blocks[2].setPosition( 0,  1);
-			blocks[3].setPosition( 1,  1);
-		}
-		else if (rotation == 2)
-		{
-			blocks[0].setPosition( 0, -1);
-			blocks[1].setPosition(-1,  0);
-			blocks[2].setPosition( 0,  0);
-			blocks[3].setPosition(-1,  1);
-		}
-		else if (rotation == 3)
-		{
-			blocks[0].setPosition(-1, -1);
-			blocks[1].setPosition( 0, -1);
-			blocks[2].setPosition( 0,  0);
-			blocks[3].setPosition( 1,  0);
-		}
-		blocks[0].setColor(sf::Color::Red);
-		blocks[1].setColor(sf::Color::Red);
-		blocks[2].setColor(sf::Color::Red);
-		blocks[3].setColor(sf::Color::Red);
-	}
-	if (blockList.size() == 0)
-	{
-		blockList.push_back(blocks[0]);
-		blockList.push_back(blocks[1]);
-		blockList.push_back(blocks[2]);
-		blockList.push_back(blocks[3]);
-	}
-	else if (blockList.size() == 4)
-	{
-		blockList[0] = blocks[0];
-		blockList[1] = blocks[1];
-		blockList[2] = blocks[2];
-		blockList[3] = blocks[3];
-	}
-}
-
-//Return the whole block list of this tetromino
-std::vector<block> tetromino::returnBlockList()
-{
-	return blockList;
-}
-
-//Returns whether or not the active tetromino can move in a specified direction
-//0: Up, 1: Left, 2: Down, 3: Right
-bool canMove(std::vector<tetromino> tetrominoList, std::vector<block> blockList, int direction)
-{
-	tetromino activeTet = tetrominoList[0];
-	if (direction == 0)
-	{
-		//TODO eventually; currently a piece will never go up
-		return false;
-	}
-	else if (direction == 1)
-	{
-		//Check border collision
-		for (int i = 0; i < activeTet.returnBlockList().size(); i++)
-		{
-			if (activeTet.returnBlockList()[i].returnPosition().x + activeTet.returnPosition().x <= 0)
-			{
-				return false;
-			}
-		}
-		//Check tetromino collision
-		for (int i = 0; i < blockList.size(); i++)
+		else
 		{
-			for (int j = 0; j < activeTet.returnBlockList().size(); j++)
-			{
-				if ((activeTet.returnBlockList()[j].returnPosition().x + activeTet.returnPosition().x - 1 == blockList[i].returnPosition().x) && (activeTet.returnBlockList()[j].returnPosition().y + activeTet.returnPosition().y == blockList[i].returnPosition().y))
-				{
-					return false;
-				}
-			}
+			throw std::runtime_error("Unknown option " + arg);
 		}
-
-		//Otherwise
-		return true;
 	}
-	else if (direction == 2)
-	{
-		//Check border collision
-		for (int i = 0; i < activeTet.returnBlockList().size(); i++)
-		{
-			if (activeTet.returnBlockList()[i].returnPosition().y + activeTet.returnPosition().y >= numRows - 1)
-			{
-				return false;
-			}
-		}
-		//Check tetromino collision
-		for (int i = 0; i < blockList.size(); i++)
-		{
-			for (int j = 0; j < activeTet.returnBlockList().size(); j++)
-			{
-				if ((activeTet.returnBlockList()[j].returnPosition().y + activeTet.returnPosition().y + 1 == blockList[i].returnPosition().y) && (activeTet.returnBlockList()[j].returnPosition().x + activeTet.returnPosition().x == blockList[i].returnPosition().x))
-				{
-					return false;
-				}
-			}
-		}
 
-		//Otherwise
-		return true;
-	}
-	else if (direction == 3)
-	{
-		//Check border collision
-		for (int i = 0; i < activeTet.returnBlockList().size(); i++)
-		{
-			if (activeTet.returnBlockList()[i].returnPosition().x + activeTet.returnPosition().x >= numColumns - 1)
-			{
-				return false;
-			}
-		}
-		//Check tetromino collision
-		for (int i = 0; i < blockList.size(); i++)
-		{
-			for (int j = 0; j < activeTet.returnBlockList().size(); j++)
-			{
-				if ((activeTet.returnBlockList()[j].returnPosition().x + activeTet.returnPosition().x + 1 == blockList[i].returnPosition().x) && (activeTet.returnBlockList()[j].returnPosition().y + activeTet.returnPosition().y == blockList[i].returnPosition().y))
-				{
-					return false;
-				}
-			}
-		}
-
-		//Otherwise
-		return true;
-	}
-	//Called when an invalid direction is passed
-	else
-	{
-		return false;
-	}
+	return options;
 }
 
-//Returns whether or not the active tetromino can rotate in a specified direction
-//1: Clockwise, -1: Counter-clockwise
-bool canRotate(std::vector<tetromino> tetrominoList, std::vector<block> blockList, int direction)
+int main(int argc, char **argv)
 {
-	tetromino activeTet = tetrominoList[tetrominoList.size() - 1];
-	activeTet.rotate(direction);
-	for (int i = 0; i < blockList.size(); i++)
+	gameOptions options;
+	try
 	{
-		for (int j = 0; j < activeTet.returnBlockList().size(); j++)
-		{
-			//If the rotated block crosses a border
-			if (activeTet.returnBlockList()[j].returnPosition().x + activeTet.returnPosition().x < 0 || activeTet.returnBlockList()[j].returnPosition().x + activeTet.returnPosition().x >= numColumns || activeTet.returnBlockList()[j].returnPosition().y + activeTet.returnPosition().y < 0 || activeTet.returnBlockList()[j].returnPosition().y + activeTet.returnPosition().y >= numRows)
-			{
-				return false;
-			}
-			//If the rotated block overlaps with any tetromino, return false
-			if (activeTet.returnBlockList()[j].returnPosition().x + activeTet.returnPosition().x  == blockList[i].returnPosition().x  && activeTet.returnBlockList()[j].returnPosition().y + activeTet.returnPosition().y == blockList[i].returnPosition().y)
-			{
-				return false;
-			}
-		}
+		options = parseOptions(argc, argv);
 	}
-
-	//Otherwise
-	return true;
-}
-
-//Returns whether or not the given row has been filled and is ready to clear
-bool isRowComplete(std::vector<block> blockList, int row)
-{
-	bool columnFilled[numColumns];
-	bool isComplete = true;
-	//tetrominoList.size()-1 so the active piece isn't included
-	for (int i = 0; i < blockList.size(); i++)
+	catch(std::exception const &e)
 	{
-		if (blockList[i].returnPosition().y == row)
-		{
-			columnFilled[blockList[i].returnPosition().x] = true;
-		}
+		std::cerr << "Exception: " << e.what() << "\n";
+		std::cerr << "Usage: tetris [--spectate boards] [--policy idle|random|ai] [--seed S] [--fps limit] [--record file] [--stats file] [--randomizer classic|bag|history] [--preview N] [--lock-delay ticks] [--das ms] [--arr ms] [--ai] [--lookahead N] [--budget ms] [--weights h,l,o,b]\n";
+		return 1;
 	}
 
-	for (int i = 0; i < numColumns; i++)
+	//Random number stuff
+	std::random_device rd;
+	if (!options.hasSeed)
 	{
-		if (!columnFilled[i])
-		{
-			isComplete = false;
-		}
+		options.seed = rd();
 	}
 
-	return isComplete;
-}
-
-//Returns a new tetromino list in which a given row has been cleared
-std::vector<block> clearRow(std::vector<block> blockList, int row)
-{
-	for (int i = 0; i < blockList.size(); i++)
+	if (options.spectateBoards > 0)
 	{
-		if (blockList[i].returnPosition().y == row)
-		{
-			blockList.erase(blockList.begin() + i);
-		}
-		
-		//Moves lines down
-		if (blockList[i].returnPosition().y < row)
-		{
-			blockList[i].move(2);
-		}
+		runSpectator(options.spectateBoards, options.policy, options.seed, options.frameLimit, options.ai, options.rules);
+		return 0;
 	}
 
-	return blockList;
-}
+	sf::RenderWindow window(sf::VideoMode(windowX, windowY), windowTitle);
+	configFrameRate(window, options.frameLimit);
+	//Held keys repeat through DAS and ARR, not through the system's key repeat
+	window.setKeyRepeatEnabled(false);
 
-int main()
-{
-	sf::RenderWindow window(sf::VideoMode(windowX, windowY), "Tetris Clone");
-
-	std::vector<std::vector<cell>> cellMap;
-	std::vector<block> blockListActive;
-	std::vector<block> decomposedTetrominos;
-	std::vector<tetromino> tetrominoList;
+	//The view holds a color byte per cell and which cells changed; only those are redrawn into the canvas
+	boardView view;
+	boardCanvas canvas(padding, padding, cellLength, lineWidth);
+	bool boardChanged = true;
 	bool isPlaying = true;
-	int score = 0;
 
-	//Random number stuff
-	std::random_device rd;
-	std::default_random_engine generator;
-	generator.seed(rd());
-	std::uniform_int_distribution<int> randomPiece(0, 6);
-
-	//Populates cell map
-	for (int i = 0; i < numColumns; i++)
+	gameState game(options.seed, options.rules);
+	//Preview tetrominos right of the board and the held one left of it
+	sf::VertexArray sidePieces(sf::Quads);
+
+	//Time not yet simulated; the game advances in fixed steps however long a frame takes
+	const std::chrono::nanoseconds tickLength(1000000000 / ticksPerSecond);
+	//Longest frame time that is caught up on, so a stalled window does not run the game ahead in a burst
+	const std::chrono::nanoseconds maxFrameTime = 8 * tickLength;
+	std::chrono::nanoseconds accumulator(0);
+	auto lastFrame = std::chrono::steady_clock::now();
+
+	//Every frame's phases are timed; F3 shows their recent timings as bars under the board and in the title,
+	//which also shows the score and is refreshed at most twice a second
+	frameProfiler profiler;
+	activeProfiler = &profiler;
+	bool showStats = false;
+	sf::VertexArray statBars(sf::Quads);
+	const std::chrono::milliseconds titleInterval(500);
+	auto lastTitle = lastFrame - titleInterval;
+	int lastScore = -1;
+
+	//Key events are stamped as they are polled and queued for the steps that stand for the time they happened in;
+	//the steps' inputs are what is recorded, so replays play back exactly whatever the DAS and ARR were
+	keyEventQueue keyEvents;
+	inputHandler handler(options.handling);
+	replayRecorder recorder(options.seed, game.returnRules());
+
+	//The AI searches every core for its move and presses keys through the same step input as the keyboard
+	std::unique_ptr<workStealingPool> searchPool;
+	std::unique_ptr<aiPlayer> autoplayer;
+	if (options.autoplay)
 	{
-		cellMap.push_back(std::vector<cell>());
-		for (int j = 0; j < numRows; j++)
-		{
-			cell newCell(i, j);
-			cellMap[i].push_back(newCell);
-		}
+		searchPool.reset(new workStealingPool());
+		autoplayer.reset(new aiPlayer(options.ai, searchPool.get()));
 	}
 
-	//Tetromino list with first random tetromino pushed
-	tetromino firstTet(randomPiece(generator));
-	tetrominoList.push_back(firstTet);
-
 	while (window.isOpen())
 	{
-		sf::Event event;
-		while (window.pollEvent(event))
+		scopedTimer frameTimer(phaseFrame);
+		globalCounters.add(counterFrames);
+
+		//Input is handled every frame so a key press reaches the active tetromino on the next drawn frame
 		{
-			if (event.type == sf::Event::Closed)
-			{
-				window.close();
-			}
-			else if (event.type == sf::Event::KeyPressed)
+			scopedTimer inputTimer(phaseInput);
+			sf::Event event;
+			while (window.pollEvent(event))
 			{
-				if (event.key.code == sf::Keyboard::Left && isPlaying && canMove(tetrominoList, decomposedTetrominos, 1))
+				if (event.type == sf::Event::Closed)
 				{
-					tetrominoList[tetrominoList.size() - 1].move(1);
+					window.close();
 				}
-				else if (event.key.code == sf::Keyboard::Right && isPlaying && canMove(tetrominoList,decomposedTetrominos, 3))
+				else if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::Space)
 				{
-					tetrominoList[tetrominoList.size() - 1].move(3);
-				}
-				else if (event.key.code == sf::Keyboard::Up && isPlaying && canRotate(tetrominoList,decomposedTetrominos, 1))
-				{
-					tetrominoList[tetrominoList.size() - 1].rotate(1);
+					//Keys held over a pause are released, as the window stops passing them on
+					isPlaying = !isPlaying;
+					handler.reset();
+					keyEvent stale;
+					while (keyEvents.pop(stale))
+					{
+					}
 				}
-				else if (event.key.code == sf::Keyboard::Down && isPlaying && canMove(tetrominoList,decomposedTetrominos, 2))
+				else if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::F3)
 				{
-					tetrominoList[tetrominoList.size() - 1].move(2);
+					showStats = !showStats;
+					lastTitle -= titleInterval;
 				}
-				else if (event.key.code == sf::Keyboard::Space)
+				else if ((event.type == sf::Event::KeyPressed || event.type == sf::Event::KeyReleased) && isPlaying)
 				{
-					if (isPlaying)
+					int key = keyFor(event.key.code);
+					if (key < numKeys && !keyEvents.push({timestampNow(), std::uint8_t(key), event.type == sf::Event::KeyPressed}))
 					{
-						isPlaying = false;
-					}
-					else
-					{
-						isPlaying = true;
+						std::cerr << "Key event queue full, dropping a key event\n";
 					}
+					globalCounters.add(counterKeyEvents, key < numKeys);
 				}
 			}
 		}
 
+		auto now = std::chrono::steady_clock::now();
+		std::chrono::nanoseconds frameTime = std::min<std::chrono::nanoseconds>(now - lastFrame, maxFrameTime);
+		lastFrame = now;
+
 		window.clear();
 		
 		if (isPlaying)
 		{
-			//Add tetromino list to displayed block list
-			for (int i = 0; i < tetrominoList.size(); i++)
-			{
-				tetrominoList[i].configBlockList();
-				for (int j = 0; j < tetrominoList[i].returnBlockList().size(); j++)
-				{
-					block tempBlock;
-					tempBlock.setPosition(tetrominoList[i].returnBlockList()[j].returnPosition().x + tetrominoList[i].returnPosition().x, tetrominoList[i].returnBlockList()[j].returnPosition().y + tetrominoList[i].returnPosition().y);
-					tempBlock.setColor(tetrominoList[i].returnBlockList()[j].returnColor());
-					blockListActive.push_back(tempBlock);
-				}
-			}
-			//Add decomposed tetrominos block list to displayed block list
-			for (int i = 0; i < decomposedTetrominos.size(); i++)
+			//Advance the game by as many fixed steps as have elapsed, starting over on a loss
 			{
-				blockListActive.push_back(decomposedTetrominos[i]);
-			}
-			
-			//Set cells that correspond to each block in the displayed block list active
-			for (int i = 0; i < blockListActive.size(); i++)
-			{	
-				if (blockListActive[i].returnPosition().x > -1 && blockListActive[i].returnPosition().x < numColumns && blockListActive[i].returnPosition().y > -1 && blockListActive[i].returnPosition().y < numRows)
+				scopedTimer simulationTimer(phaseSimulation);
+				accumulator += frameTime;
+				//Each step stands for the tickLength of time ending accumulator - tickLength before now
+				while (accumulator >= tickLength)
 				{
-					cellMap[blockListActive[i].returnPosition().x][blockListActive[i].returnPosition().y].configFill(blockListActive[i].returnColor());
-					cellMap[blockListActive[i].returnPosition().x][blockListActive[i].returnPosition().y].setIsFilled(true);
+					std::int64_t stepEnd = std::chrono::duration_cast<std::chrono::nanoseconds>(now.time_since_epoch()).count() - (accumulator - tickLength).count();
+					input in = handler.nextStep(keyEvents, stepEnd);
+					if (autoplayer)
+					{
+						in.flags |= autoplayer->nextInput(game).flags;
+					}
+					if (!options.recordPath.empty())
+					{
+						recorder.record(game, in);
+					}
+					stepResult result = game.step(in);
+					globalCounters.add(counterSteps);
+					globalCounters.add(counterLocks, result.locked);
+					globalCounters.add(counterLines, result.linesCleared);
+					boardChanged |= result.locked;
+					if (game.isGameOver())
+					{
+						game.restart();
+					}
+					accumulator -= tickLength;
 				}
 			}
-	
-			//Move down each tick if it is possible
-			if (canMove(tetrominoList, decomposedTetrominos, 2))
-			{
-				tetrominoList[tetrominoList.size() - 1].move(2);
-			}
-			//Else spawn a new tetromino and decompose the previous tetromino
-			else
-			{
-				decomposedTetrominos = tetrominoList[0].decompose(decomposedTetrominos);
-				tetrominoList.pop_back();
-				tetromino newTet(randomPiece(generator));
-				tetrominoList.push_back(newTet);
-			}
-			
-			//Loss checking
-			for (int i = 0; i < decomposedTetrominos.size(); i++)
+
 			{
-				if (decomposedTetrominos[i].returnPosition().x == numColumns / 2 && decomposedTetrominos[i].returnPosition().y == 0)
+				scopedTimer cellMapTimer(phaseCellMap);
+
+				//Locked blocks are only compared when a tetromino locks; the active and ghost tetrominos redraw the cells
+				//they left and the cells they moved to, and without a persistent canvas every cell is drawn every frame
+				view.update(game, boardChanged);
+				boardChanged = false;
+				if (!canvas.returnIsPersistent())
 				{
-					score = 0;
-					decomposedTetrominos.clear();
+					view.markAll();
 				}
-			}
-
-			//Line checking
+				addDirtyCells(canvas, view);
+				view.clearDirty();
+				canvas.flush();
 
-			std::vector<int> linesCleared;
-
-			for (int i = 0; i < numRows; i++)
-			{
-				if (isRowComplete(decomposedTetrominos, i))
+				sidePieces.clear();
+				for (int i = 0; i < game.returnPreviewCount(); i++)
 				{
-					linesCleared.push_back(i);
+					appendPiece(sidePieces, game.returnPreview(i), padding + numColumns * cellLength + sideCellLength, padding + i * 3 * sideCellLength, sideCellLength);
 				}
-			}
-
-			if (linesCleared.size() == 0)
-			{
-				//This will be true for the majority of the game so I am including it as the first of this if else-if change to save processing time
-			}
-			else if (linesCleared.size() == 1)
-			{
-				score += 40;
-			}
-			else if (linesCleared.size() == 2)
-			{
-				score += 100;
-			}
-			else if (linesCleared.size() == 3)
-			{
-				score += 300;
-			}
-			else if (linesCleared.size() == 4)
-			{
-				score += 1200;
-			}
-
-			while (linesCleared.size() > 0)
-			{
-				decomposedTetrominos = clearRow(decomposedTetrominos, linesCleared[0]);
-				linesCleared.erase(linesCleared.begin());
-			}
-			
-			//Draw filled cells
-			for (int i = 0; i < numColumns; i++)
-			{
-				for (int j = 0; j < numRows; j++)
+				if (game.returnHeld() >= 0)
 				{
-					for (int k = 0; k < 4; k++)
-					{
-						window.draw(cellMap[i][j].returnLine(k));
-					}
-
-					if (cellMap[i][j].returnIsFilled())
-					{
-						window.draw(cellMap[i][j].returnFill());
-					}
+					appendPiece(sidePieces, game.returnHeld(), sideCellLength, padding, sideCellLength);
 				}
 			}
 
-			std::cout << score << std::endl;
+			//Draw the board canvas, then the side pieces
+			scopedTimer drawTimer(phaseDraw);
+			window.draw(canvas);
+			window.draw(sidePieces);
 		}
 
-		window.display();
+		if (showStats)
+		{
+			statBars.clear();
+			appendPhaseBars(statBars, profiler, padding, padding + numRows * cellLength + lineWidth + 4, numColumns * cellLength, (padding - 8) / numPhases, tickLength);
+			window.draw(statBars);
+		}
 
-		for (int i = 0; i < numColumns; i++)
+		//The score and the recent timings go in the title instead of the console, which would flush every change
+		if (now - lastTitle >= titleInterval || game.returnScore() != lastScore)
 		{
-			for (int j = 0; j < numRows; j++)
+			lastScore = game.returnScore();
+			window.setTitle(windowTitle + " - " + std::to_string(lastScore) + (showStats ? " - " + profiler.summary() : ""));
+			if (now - lastTitle >= titleInterval)
 			{
-				cellMap[i][j].setIsFilled(false);
+				profiler.startRecent();
+				lastTitle = now;
 			}
 		}
 
-		blockListActive.clear();
+		window.display();
+	}
+	activeProfiler = nullptr;
 
-		//Tick timer
-		std::this_thread::sleep_for(std::chrono::milliseconds(150));
+	if (!options.statsPath.empty())
+	{
+		try
+		{
+			profiler.saveToFile(options.statsPath);
+		}
+		catch(std::exception const &e)
+		{
+			std::cerr << "Exception: " << e.what() << "\n";
+			return 1;
+		}
+	}
+
+	if (!options.recordPath.empty())
+	{
+		try
+		{
+			recorder.saveToFile(options.recordPath);
+		}
+		catch(std::exception const &e)
+		{
+			std::cerr << "Exception: " << e.what() << "\n";
+			return 1;
+		}
 	}
 }
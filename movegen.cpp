@@ -0,0 +1,310 @@
+#include <algorithm>
+#include "movegen.hpp"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define MOVEGEN_AVX2 1
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define MOVEGEN_SSE2 1
+#endif
+
+namespace
+{
+	//Rows of fit masks computed per rotation, a multiple of every vector width reaching from the hidden rows past the floor
+	//Fit row j is for pieces centered on board row j - hiddenRows
+	constexpr int fitRows = 32;
+	static_assert(fitRows > hiddenRows + numRows, "Fit masks must reach the floor");
+	//The board is copied with the empty hidden rows above the top, full rows above those, where pieces cannot go,
+	//and full rows below the floor
+	constexpr int padTop = hiddenRows + 4;
+	constexpr int paddedRows = padTop - hiddenRows + fitRows + 16;
+
+	//Returns whether two layouts cover the same cells once moved onto each other
+	constexpr bool sameFootprint(const pieceLayout &a, const pieceLayout &b)
+	{
+		if (a.width != b.width || a.height != b.height)
+		{
+			return false;
+		}
+		for (int i = 0; i < blocksPerPiece; i++)
+		{
+			if (a.rowMasks[i] != b.rowMasks[i])
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	//For every shape and rotation, a bit per earlier rotation with the same footprint
+	//A placement in such a rotation is a duplicate when the earlier rotation locks on the same cells
+	struct footprintTable
+	{
+		std::uint8_t earlier[numShapes][numRotations];
+	};
+
+	constexpr footprintTable makeFootprintTable()
+	{
+		footprintTable table{};
+		for (int shape = 0; shape < numShapes; shape++)
+		{
+			for (int rotation = 0; rotation < numRotations; rotation++)
+			{
+				for (int other = 0; other < rotation; other++)
+				{
+					if (sameFootprint(pieces.layouts[shape][rotation], pieces.layouts[shape][other]))
+					{
+						table.earlier[shape][rotation] |= 1 << other;
+					}
+				}
+			}
+		}
+		return table;
+	}
+
+	constexpr footprintTable footprints = makeFootprintTable();
+
+	static_assert(footprints.earlier[1][3] == 7, "Every O rotation has the same footprint");
+	static_assert(footprints.earlier[0][2] == 1 && footprints.earlier[0][3] == 2, "I rotations pair up");
+	static_assert(footprints.earlier[2][3] == 0, "T rotations all differ");
+
+	/* Fills fits[y] with a bit for every center column x at which the piece fits with its center on fit row y
+	A piece whose leftmost column is L overlaps a row r when (mask << L) & r is not zero, so the overlapping L
+	of every column at once are the OR of r shifted right by each set bit of the mask
+	Every row y is independent, so they are computed a vector of rows at a time */
+	void computeFits(const std::uint16_t *padded, const pieceLayout &layout, std::uint16_t *fits)
+	{
+		const std::uint16_t leftLimit = (1u << (numColumns - layout.width + 1)) - 1;
+		const int toCenter = -layout.minX;
+
+#if defined(MOVEGEN_AVX2)
+		const __m256i limit = _mm256_set1_epi16(leftLimit);
+		const __m128i centerShift = _mm_cvtsi32_si128(toCenter);
+		for (int y = 0; y < fitRows; y += 16)
+		{
+			__m256i blocked = _mm256_setzero_si256();
+			for (int i = 0; i < layout.height; i++)
+			{
+				__m256i rows = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(padded + padTop - hiddenRows + y + layout.minY + i));
+				for (int bit = 0; bit < layout.width; bit++)
+				{
+					if ((layout.rowMasks[i] >> bit) & 1)
+					{
+						blocked = _mm256_or_si256(blocked, _mm256_srl_epi16(rows, _mm_cvtsi32_si128(bit)));
+					}
+				}
+			}
+			__m256i fit = _mm256_andnot_si256(blocked, limit);
+			_mm256_storeu_si256(reinterpret_cast<__m256i *>(fits + y), _mm256_sll_epi16(fit, centerShift));
+		}
+#elif defined(MOVEGEN_SSE2)
+		const __m128i limit = _mm_set1_epi16(leftLimit);
+		const __m128i centerShift = _mm_cvtsi32_si128(toCenter);
+		for (int y = 0; y < fitRows; y += 8)
+		{
+			__m128i blocked = _mm_setzero_si128();
+			for (int i = 0; i < layout.height; i++)
+			{
+				__m128i rows = _mm_loadu_si128(reinterpret_cast<const __m128i *>(padded + padTop - hiddenRows + y + layout.minY + i));
+				for (int bit = 0; bit < layout.width; bit++)
+				{
+					if ((layout.rowMasks[i] >> bit) & 1)
+					{
+						blocked = _mm_or_si128(blocked, _mm_srl_epi16(rows, _mm_cvtsi32_si128(bit)));
+					}
+				}
+			}
+			__m128i fit = _mm_andnot_si128(blocked, limit);
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(fits + y), _mm_sll_epi16(fit, centerShift));
+		}
+#else
+		for (int y = 0; y < fitRows; y++)
+		{
+			std::uint16_t blocked = 0;
+			for (int i = 0; i < layout.height; i++)
+			{
+				std::uint16_t row = padded[padTop - hiddenRows + y + layout.minY + i];
+				for (int bit = 0; bit < layout.width; bit++)
+				{
+					if ((layout.rowMasks[i] >> bit) & 1)
+					{
+						blocked |= row >> bit;
+					}
+				}
+			}
+			fits[y] = std::uint16_t((leftLimit & ~blocked) << toCenter);
+		}
+#endif
+	}
+
+	//Grows the reached columns of a row left and right through every column the piece fits in
+	std::uint16_t spreadRow(std::uint16_t reached, std::uint16_t fit)
+	{
+		std::uint16_t previous;
+		do
+		{
+			previous = reached;
+			reached |= ((reached << 1) | (reached >> 1)) & fit;
+		}
+		while (reached != previous);
+
+		return reached;
+	}
+
+	//Moves every column of a mask by dx, right for positive dx
+	std::uint16_t shiftColumns(std::uint16_t mask, int dx)
+	{
+		return std::uint16_t(dx >= 0 ? mask << dx : mask >> -dx);
+	}
+}
+
+/* Fills out with every placement the tetromino can lock at, reached from where it is with left, right, down,
+clockwise, counter-clockwise and half turn moves, as many as it takes between rows
+The reachable states are flood filled a row at a time from the top, each row holding a column mask per rotation
+A turn tries its SRS kicks in order on the whole row at once, each kick taking the columns it fits at out of the
+columns still trying; kicks that lift the piece into a row already filled mean another pass from the top
+Placements covering the same cells in different rotations are listed once */
+void findPlacements(const board &field, const tetromino &start, placementList &out)
+{
+	out.clear();
+	int shape = start.returnShape();
+	position p = start.returnPosition();
+	if (p.x < 0 || p.x >= numColumns || p.y < -hiddenRows || p.y >= numRows)
+	{
+		return;
+	}
+
+	alignas(32) std::uint16_t padded[paddedRows];
+	for (int i = 0; i < paddedRows; i++)
+	{
+		int y = i - padTop;
+		padded[i] = y < -hiddenRows ? 0xFFFF : y < 0 ? 0 : y < numRows ? field.returnRow(y) : 0xFFFF;
+	}
+
+	alignas(32) std::uint16_t fits[numRotations][fitRows];
+	for (int rotation = 0; rotation < numRotations; rotation++)
+	{
+		computeFits(padded, returnLayout(shape, rotation), fits[rotation]);
+	}
+
+	const int turns[] = {1, 2, -1};
+	std::uint16_t reached[numRotations][fitRows] = {};
+	int startRow = p.y + hiddenRows;
+	reached[start.returnRotation()][startRow] = fits[start.returnRotation()][startRow] & (1u << p.x);
+	int firstRow = startRow;
+	while (firstRow < fitRows - 1)
+	{
+		int passStart = firstRow;
+		firstRow = fitRows;
+		for (int y = passStart; y < fitRows - 1; y++)
+		{
+			if (!(reached[0][y] | reached[1][y] | reached[2][y] | reached[3][y]))
+			{
+				continue;
+			}
+
+			//Side moves and turns within the row until nothing new is reached
+			bool changed = true;
+			while (changed)
+			{
+				changed = false;
+				for (int rotation = 0; rotation < numRotations; rotation++)
+				{
+					std::uint16_t spread = spreadRow(reached[rotation][y], fits[rotation][y]);
+					changed |= spread != reached[rotation][y];
+					reached[rotation][y] = spread;
+				}
+
+				for (int rotation = 0; rotation < numRotations; rotation++)
+				{
+					for (int t = 0; t < 3; t++)
+					{
+						std::uint16_t trying = reached[rotation][y];
+						int target = (rotation + turns[t] + numRotations) % numRotations;
+						const kickList &list = returnKicks(shape, rotation, turns[t]);
+						for (int k = 0; k < list.count && trying; k++)
+						{
+							int targetRow = y + list.tests[k].y;
+							if (targetRow < 0 || targetRow >= fitRows - 1)
+							{
+								continue;
+							}
+
+							std::uint16_t fit = fits[target][targetRow];
+							std::uint16_t landed = reached[target][targetRow] | (shiftColumns(trying, list.tests[k].x) & fit);
+							trying &= ~shiftColumns(fit, -list.tests[k].x);
+							if (landed != reached[target][targetRow])
+							{
+								reached[target][targetRow] = landed;
+								changed |= targetRow == y;
+								firstRow = targetRow < y ? std::min(firstRow, targetRow) : firstRow;
+							}
+						}
+					}
+				}
+			}
+
+			//Whatever can move down also falls to the next row
+			for (int rotation = 0; rotation < numRotations; rotation++)
+			{
+				reached[rotation][y + 1] |= reached[rotation][y] & fits[rotation][y + 1];
+			}
+		}
+	}
+
+	//Whatever cannot move down locks where it is; placements with any block above the top row would lose the game,
+	//as isLockedOut tells the game, so they are left out
+	std::uint16_t locks[numRotations][numRows];
+	for (int rotation = 0; rotation < numRotations; rotation++)
+	{
+		int firstRow = -returnLayout(shape, rotation).minY;
+		for (int y = 0; y < numRows; y++)
+		{
+			locks[rotation][y] = y < firstRow ? 0 : reached[rotation][y + hiddenRows] & ~fits[rotation][y + hiddenRows + 1];
+		}
+	}
+
+	for (int rotation = 0; rotation < numRotations; rotation++)
+	{
+		const pieceLayout &layout = returnLayout(shape, rotation);
+		for (int y = 0; y < numRows; y++)
+		{
+			std::uint32_t mask = locks[rotation][y];
+			while (mask)
+			{
+				int x = lowestSetBit(mask);
+				mask &= mask - 1;
+
+				bool duplicate = false;
+				for (int other = 0; other < rotation && !duplicate; other++)
+				{
+					if ((footprints.earlier[shape][rotation] >> other) & 1)
+					{
+						const pieceLayout &otherLayout = returnLayout(shape, other);
+						int otherX = x + layout.minX - otherLayout.minX;
+						int otherY = y + layout.minY - otherLayout.minY;
+						duplicate = otherX >= 0 && otherX < numColumns && otherY >= 0 && otherY < numRows && ((locks[other][otherY] >> otherX) & 1);
+					}
+				}
+
+				if (!duplicate)
+				{
+					out.add({std::int8_t(x), std::int8_t(y), std::int8_t(rotation)});
+				}
+			}
+		}
+	}
+}
+
+//Returns the instruction set the fit masks are computed with
+const char *returnMoveGenInstructionSet()
+{
+#if defined(MOVEGEN_AVX2)
+	return "avx2";
+#elif defined(MOVEGEN_SSE2)
+	return "sse2";
+#else
+	return "scalar";
+#endif
+}
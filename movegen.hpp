@@ -0,0 +1,50 @@
+#ifndef MOVEGEN_HPP
+#define MOVEGEN_HPP
+
+#include <cstdint>
+#include "board.hpp"
+#include "pieces.hpp"
+#include "tetromino.hpp"
+
+//Most placements a piece can have, one per rotation, row and column
+constexpr int maxPlacements = numRotations * numRows * numColumns;
+
+//Where a tetromino locks: its center and rotation, as taken by tetromino::setPlacement
+struct placement
+{
+	std::int8_t x, y, rotation;
+};
+
+//Fixed capacity list of placements, so that move generation never allocates
+class placementList
+{
+	private:
+		placement moves[maxPlacements];
+		int count = 0;
+
+	public:
+		void clear()
+		{
+			count = 0;
+		}
+
+		void add(placement move)
+		{
+			moves[count++] = move;
+		}
+
+		int returnCount() const
+		{
+			return count;
+		}
+
+		const placement &returnPlacement(int i) const
+		{
+			return moves[i];
+		}
+};
+
+void findPlacements(const board &field, const tetromino &start, placementList &out);
+const char *returnMoveGenInstructionSet();
+
+#endif
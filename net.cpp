@@ -0,0 +1,333 @@
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "net.hpp"
+#include "serial.hpp"
+
+//Constructor taking ownership of a connected socket and making it non-blocking
+connection::connection(int setFd) : fd(setFd)
+{
+	fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+}
+
+//Destructor closing the socket
+connection::~connection()
+{
+	close(fd);
+}
+
+//Returns an empty buffer to write the next message into, to be sent with endMessage
+std::vector<std::uint8_t> &connection::startMessage()
+{
+	scratch.clear();
+	return scratch;
+}
+
+//Queues the message written since startMessage behind its length
+void connection::endMessage()
+{
+	if (outgoingStart == outgoing.size())
+	{
+		outgoing.clear();
+		outgoingStart = 0;
+	}
+	else if (outgoingStart >= compactBytes)
+	{
+		//A peer that never quite catches up would otherwise keep every byte ever sent to it in the buffer
+		outgoing.erase(outgoing.begin(), outgoing.begin() + outgoingStart);
+		outgoingStart = 0;
+	}
+
+	byteWriter out(outgoing);
+	out.writeVarint(scratch.size());
+	out.writeBytes(scratch.data(), scratch.size());
+}
+
+//Reads everything the socket has for now
+//Returns false once the other side has closed the connection or it failed
+bool connection::receive()
+{
+	//Messages handed out by nextMessage are done with by the time more is read
+	incoming.erase(incoming.begin(), incoming.begin() + incomingStart);
+	incomingStart = 0;
+
+	std::uint8_t buffer[4096];
+	while (true)
+	{
+		ssize_t count = recv(fd, buffer, sizeof(buffer), 0);
+		if (count > 0)
+		{
+			incoming.insert(incoming.end(), buffer, buffer + count);
+			bytesReceived += count;
+		}
+		else if (count == 0)
+		{
+			return false;
+		}
+		else if (errno == EAGAIN || errno == EWOULDBLOCK)
+		{
+			return true;
+		}
+		else if (errno != EINTR)
+		{
+			return false;
+		}
+	}
+}
+
+//Points data at the next whole message received, which stays valid until the next call to receive
+//Returns false when no whole message is buffered, and throws when a message is longer than maxMessageSize or its
+//length prefix runs past maxPrefixBytes, so that a peer cannot make the buffer grow without end
+bool connection::nextMessage(const std::uint8_t *&data, std::size_t &size)
+{
+	std::size_t length = 0;
+	std::size_t offset = incomingStart;
+	for (int shift = 0; ; shift += 7)
+	{
+		if (shift >= 7 * maxPrefixBytes)
+		{
+			throw std::runtime_error("Message length prefix too long");
+		}
+		if (offset >= incoming.size())
+		{
+			return false;
+		}
+		std::uint8_t next = incoming[offset++];
+		length |= std::size_t(next & 0x7F) << shift;
+		if (length > maxMessageSize)
+		{
+			throw std::runtime_error("Message too long");
+		}
+		if (!(next & 0x80))
+		{
+			break;
+		}
+	}
+	if (incoming.size() - offset < length)
+	{
+		return false;
+	}
+
+	data = incoming.data() + offset;
+	size = length;
+	incomingStart = offset + length;
+	return true;
+}
+
+//Sends as much of the queued messages as the socket takes without blocking
+//Returns false when the connection failed
+bool connection::flush()
+{
+	while (outgoingStart < outgoing.size())
+	{
+		ssize_t count = send(fd, outgoing.data() + outgoingStart, outgoing.size() - outgoingStart, MSG_NOSIGNAL);
+		if (count > 0)
+		{
+			outgoingStart += count;
+			bytesSent += count;
+		}
+		else if (errno == EAGAIN || errno == EWOULDBLOCK)
+		{
+			return true;
+		}
+		else if (errno != EINTR)
+		{
+			return false;
+		}
+	}
+
+	outgoing.clear();
+	outgoingStart = 0;
+	return true;
+}
+
+//Returns whether queued messages are still waiting for the socket to take them
+bool connection::hasPending() const
+{
+	return outgoingStart < outgoing.size();
+}
+
+//Returns the number of queued bytes the socket has not taken yet
+std::size_t connection::returnPendingBytes() const
+{
+	return outgoing.size() - outgoingStart;
+}
+
+//Returns the socket
+int connection::returnFd() const
+{
+	return fd;
+}
+
+//Returns the number of bytes the socket has taken, length prefixes included
+std::uint64_t connection::returnBytesSent() const
+{
+	return bytesSent;
+}
+
+//Returns the number of bytes read from the socket
+std::uint64_t connection::returnBytesReceived() const
+{
+	return bytesReceived;
+}
+
+namespace
+{
+	//Splits an address into a Unix socket path, for unix:PATH, or a host and a port, for HOST:PORT
+	//Returns whether it is a Unix socket
+	bool splitAddress(const std::string &address, std::string &host, std::string &port)
+	{
+		if (address.compare(0, 5, "unix:") == 0)
+		{
+			host = address.substr(5);
+			if (host.empty() || host.size() >= sizeof(sockaddr_un::sun_path))
+			{
+				throw std::runtime_error("Invalid Unix socket path in " + address);
+			}
+			return true;
+		}
+
+		std::size_t split = address.rfind(':');
+		if (split == std::string::npos || split == 0 || split + 1 == address.size())
+		{
+			throw std::runtime_error("Addresses are unix:PATH or HOST:PORT, not " + address);
+		}
+		host = address.substr(0, split);
+		port = address.substr(split + 1);
+		return false;
+	}
+
+	//Fills in the address of a Unix socket
+	sockaddr_un unixAddress(const std::string &path)
+	{
+		sockaddr_un name;
+		std::memset(&name, 0, sizeof(name));
+		name.sun_family = AF_UNIX;
+		std::memcpy(name.sun_path, path.data(), path.size());
+		return name;
+	}
+
+	//Opens a TCP socket to or on a host and port, listening when passive is set
+	int openTcp(const std::string &host, const std::string &port, bool passive)
+	{
+		addrinfo hints;
+		std::memset(&hints, 0, sizeof(hints));
+		hints.ai_family = AF_UNSPEC;
+		hints.ai_socktype = SOCK_STREAM;
+		hints.ai_flags = passive ? AI_PASSIVE : 0;
+		addrinfo *found = nullptr;
+		if (getaddrinfo(host.c_str(), port.c_str(), &hints, &found) != 0)
+		{
+			throw std::runtime_error("Could not resolve " + host + ":" + port);
+		}
+
+		int fd = -1;
+		for (addrinfo *candidate = found; candidate && fd < 0; candidate = candidate->ai_next)
+		{
+			fd = socket(candidate->ai_family, candidate->ai_socktype, candidate->ai_protocol);
+			if (fd < 0)
+			{
+				continue;
+			}
+
+			int on = 1;
+			bool opened;
+			if (passive)
+			{
+				setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+				opened = bind(fd, candidate->ai_addr, candidate->ai_addrlen) == 0 && listen(fd, 128) == 0;
+			}
+			else
+			{
+				//Input frames are a few bytes each and should leave at once rather than wait to be merged
+				setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+				opened = connect(fd, candidate->ai_addr, candidate->ai_addrlen) == 0;
+			}
+			if (!opened)
+			{
+				close(fd);
+				fd = -1;
+			}
+		}
+		freeaddrinfo(found);
+
+		if (fd < 0)
+		{
+			throw std::runtime_error(std::string(passive ? "Could not listen on " : "Could not connect to ") + host + ":" + port);
+		}
+		return fd;
+	}
+}
+
+//Opens a non-blocking socket listening on unix:PATH or HOST:PORT
+//A Unix socket left behind at the path by an earlier server is replaced
+int listenSocket(const std::string &address)
+{
+	std::string host, port;
+	int fd;
+	if (splitAddress(address, host, port))
+	{
+		sockaddr_un name = unixAddress(host);
+		unlink(host.c_str());
+		fd = socket(AF_UNIX, SOCK_STREAM, 0);
+		if (fd < 0 || bind(fd, reinterpret_cast<sockaddr *>(&name), sizeof(name)) != 0 || listen(fd, 128) != 0)
+		{
+			if (fd >= 0)
+			{
+				close(fd);
+			}
+			throw std::runtime_error("Could not listen on " + address);
+		}
+	}
+	else
+	{
+		fd = openTcp(host, port, true);
+	}
+
+	fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+	return fd;
+}
+
+//Accepts a client waiting on a listening socket, returning -1 when none is
+//Updates are small and sent every tick, so TCP clients get them without waiting to be merged
+int acceptSocket(int listenFd)
+{
+	int fd = accept(listenFd, nullptr, nullptr);
+	sockaddr_storage name;
+	socklen_t nameLength = sizeof(name);
+	if (fd >= 0 && getsockname(fd, reinterpret_cast<sockaddr *>(&name), &nameLength) == 0 && name.ss_family != AF_UNIX)
+	{
+		int on = 1;
+		setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+	}
+	return fd;
+}
+
+//Connects a socket to a server on unix:PATH or HOST:PORT, waiting until it is connected
+int connectSocket(const std::string &address)
+{
+	std::string host, port;
+	if (!splitAddress(address, host, port))
+	{
+		return openTcp(host, port, false);
+	}
+
+	sockaddr_un name = unixAddress(host);
+	int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (fd < 0 || connect(fd, reinterpret_cast<sockaddr *>(&name), sizeof(name)) != 0)
+	{
+		if (fd >= 0)
+		{
+			close(fd);
+		}
+		throw std::runtime_error("Could not connect to " + address);
+	}
+	return fd;
+}
@@ -0,0 +1,56 @@
+#ifndef NET_HPP
+#define NET_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+//Largest message either side accepts; a board update of a standard board is well under 200 bytes
+constexpr std::size_t maxMessageSize = 4096;
+//Longest varint length prefix either side accepts, enough for any message up to maxMessageSize
+constexpr int maxPrefixBytes = 2;
+static_assert(maxMessageSize < (std::size_t(1) << (7 * maxPrefixBytes)), "The length prefix must fit every message");
+//Sent bytes kept at the front of the send buffer before the unsent rest is moved down over them
+constexpr std::size_t compactBytes = 64 * 1024;
+
+//Message stream over a non-blocking socket, every message framed by its length as a varint
+//Received bytes are buffered until a whole message is in, and sent ones until the socket takes them,
+//so neither side ever blocks on the other
+class connection
+{
+	private:
+		int fd;
+		std::vector<std::uint8_t> incoming;
+		std::size_t incomingStart = 0;
+		std::vector<std::uint8_t> outgoing;
+		std::size_t outgoingStart = 0;
+		//Message being written, reused so that writing one does not allocate once it has grown
+		std::vector<std::uint8_t> scratch;
+		std::uint64_t bytesSent = 0;
+		std::uint64_t bytesReceived = 0;
+
+	public:
+		connection(int setFd);
+		~connection();
+		connection(const connection &) = delete;
+		connection &operator=(const connection &) = delete;
+
+		std::vector<std::uint8_t> &startMessage();
+		void endMessage();
+		bool receive();
+		bool nextMessage(const std::uint8_t *&data, std::size_t &size);
+		bool flush();
+		bool hasPending() const;
+		std::size_t returnPendingBytes() const;
+
+		int returnFd() const;
+		std::uint64_t returnBytesSent() const;
+		std::uint64_t returnBytesReceived() const;
+};
+
+int listenSocket(const std::string &address);
+int acceptSocket(int listenFd);
+int connectSocket(const std::string &address);
+
+#endif
@@ -0,0 +1,291 @@
+#ifndef PIECES_HPP
+#define PIECES_HPP
+
+#include <cstdint>
+#include "board.hpp"
+
+constexpr int numShapes = 7;
+constexpr int numRotations = 4;
+constexpr int blocksPerPiece = 4;
+
+//Offset of one block from the center of its tetromino
+struct cellOffset
+{
+	std::int8_t x, y;
+};
+
+//Precomputed layout of one shape in one rotation
+struct pieceLayout
+{
+	cellOffset cells[blocksPerPiece];
+	//Bounding box of the block offsets
+	std::int8_t minX, minY, width, height;
+	//One mask per row of the bounding box; bit 0 is column minX and mask 0 is row minY
+	std::uint16_t rowMasks[blocksPerPiece];
+	//Lowest block of every column of the bounding box, counted from row minY
+	std::int8_t columnBottoms[blocksPerPiece];
+};
+
+/* Block offsets indexed by shape ID and rotation, in the orientations of the Super Rotation System
+Every rotation is the one before it turned 90 degrees clockwise about the center block at (0, 0), so the
+offsets SRS moves the I and O pieces by are left to their kick tables
+Shape IDs: 0 - I, 1 - O, 2 - T, 3 - J, 4 - L, 5 - S, 6 - Z
+Rotation IDs: 0 - spawn, 1 - 90 degrees clockwise, 2 - 180 degrees, 3 - 90 degrees counter-clockwise */
+constexpr cellOffset pieceOffsets[numShapes][numRotations][blocksPerPiece] =
+{
+	//I
+	{
+		{{-1,  0}, { 0,  0}, { 1,  0}, { 2,  0}},
+		{{ 0, -1}, { 0,  0}, { 0,  1}, { 0,  2}},
+		{{-2,  0}, {-1,  0}, { 0,  0}, { 1,  0}},
+		{{ 0, -2}, { 0, -1}, { 0,  0}, { 0,  1}}
+	},
+	//O
+	{
+		{{ 0, -1}, { 1, -1}, { 0,  0}, { 1,  0}},
+		{{ 0,  0}, { 1,  0}, { 0,  1}, { 1,  1}},
+		{{-1,  0}, { 0,  0}, {-1,  1}, { 0,  1}},
+		{{-1, -1}, { 0, -1}, {-1,  0}, { 0,  0}}
+	},
+	//T
+	{
+		{{ 0, -1}, {-1,  0}, { 0,  0}, { 1,  0}},
+		{{ 0, -1}, { 0,  0}, { 1,  0}, { 0,  1}},
+		{{-1,  0}, { 0,  0}, { 1,  0}, { 0,  1}},
+		{{ 0, -1}, {-1,  0}, { 0,  0}, { 0,  1}}
+	},
+	//J
+	{
+		{{-1, -1}, {-1,  0}, { 0,  0}, { 1,  0}},
+		{{ 0, -1}, { 1, -1}, { 0,  0}, { 0,  1}},
+		{{-1,  0}, { 0,  0}, { 1,  0}, { 1,  1}},
+		{{ 0, -1}, { 0,  0}, {-1,  1}, { 0,  1}}
+	},
+	//L
+	{
+		{{ 1, -1}, {-1,  0}, { 0,  0}, { 1,  0}},
+		{{ 0, -1}, { 0,  0}, { 0,  1}, { 1,  1}},
+		{{-1,  0}, { 0,  0}, { 1,  0}, {-1,  1}},
+		{{-1, -1}, { 0, -1}, { 0,  0}, { 0,  1}}
+	},
+	//S
+	{
+		{{ 0, -1}, { 1, -1}, {-1,  0}, { 0,  0}},
+		{{ 0, -1}, { 0,  0}, { 1,  0}, { 1,  1}},
+		{{ 0,  0}, { 1,  0}, {-1,  1}, { 0,  1}},
+		{{-1, -1}, {-1,  0}, { 0,  0}, { 0,  1}}
+	},
+	//Z
+	{
+		{{-1, -1}, { 0, -1}, { 0,  0}, { 1,  0}},
+		{{ 1, -1}, { 0,  0}, { 1,  0}, { 0,  1}},
+		{{-1,  0}, { 0,  0}, { 0,  1}, { 1,  1}},
+		{{ 0, -1}, {-1,  0}, { 0,  0}, {-1,  1}}
+	}
+};
+
+//Builds the layout of a shape in a rotation from its block offsets at compile time
+constexpr pieceLayout makePieceLayout(int shape, int rotation)
+{
+	pieceLayout layout{};
+	int minX = 0, minY = 0, maxX = 0, maxY = 0;
+	for (int i = 0; i < blocksPerPiece; i++)
+	{
+		const cellOffset &c = pieceOffsets[shape][rotation][i];
+		layout.cells[i] = c;
+		minX = (i == 0 || c.x < minX) ? c.x : minX;
+		minY = (i == 0 || c.y < minY) ? c.y : minY;
+		maxX = (i == 0 || c.x > maxX) ? c.x : maxX;
+		maxY = (i == 0 || c.y > maxY) ? c.y : maxY;
+	}
+
+	layout.minX = minX;
+	layout.minY = minY;
+	layout.width = maxX - minX + 1;
+	layout.height = maxY - minY + 1;
+	for (int i = 0; i < blocksPerPiece; i++)
+	{
+		const cellOffset &c = pieceOffsets[shape][rotation][i];
+		layout.rowMasks[c.y - minY] |= std::uint16_t(1u << (c.x - minX));
+		std::int8_t &bottom = layout.columnBottoms[c.x - minX];
+		bottom = c.y - minY > bottom ? c.y - minY : bottom;
+	}
+
+	return layout;
+}
+
+//Every shape in every rotation
+struct pieceTable
+{
+	pieceLayout layouts[numShapes][numRotations];
+};
+
+constexpr pieceTable makePieceTable()
+{
+	pieceTable table{};
+	for (int shape = 0; shape < numShapes; shape++)
+	{
+		for (int rotation = 0; rotation < numRotations; rotation++)
+		{
+			table.layouts[shape][rotation] = makePieceLayout(shape, rotation);
+		}
+	}
+
+	return table;
+}
+
+constexpr pieceTable pieces = makePieceTable();
+
+static_assert(pieces.layouts[0][1].height == 4 && pieces.layouts[0][1].rowMasks[3] == 1, "Vertical I piece table");
+static_assert(pieces.layouts[2][0].rowMasks[0] == 2 && pieces.layouts[2][0].rowMasks[1] == 7, "T piece table");
+static_assert(pieces.layouts[2][2].columnBottoms[0] == 0 && pieces.layouts[2][2].columnBottoms[1] == 1 && pieces.layouts[2][2].columnBottoms[2] == 0, "T piece column bottoms");
+
+//Returns whether every rotation of every shape is the rotation before it turned clockwise about (0, 0)
+constexpr bool rotationsTurnClockwise()
+{
+	for (int shape = 0; shape < numShapes; shape++)
+	{
+		for (int rotation = 0; rotation < numRotations; rotation++)
+		{
+			for (int i = 0; i < blocksPerPiece; i++)
+			{
+				const cellOffset &c = pieceOffsets[shape][rotation][i];
+				bool found = false;
+				for (int j = 0; j < blocksPerPiece; j++)
+				{
+					const cellOffset &next = pieceOffsets[shape][(rotation + 1) % numRotations][j];
+					found = found || (next.x == -c.y && next.y == c.x);
+				}
+				if (!found)
+				{
+					return false;
+				}
+			}
+		}
+	}
+	return true;
+}
+
+static_assert(rotationsTurnClockwise(), "Piece rotations must turn clockwise about the center block");
+
+/* SRS offsets of every rotation, five per rotation, with y pointing up as SRS tables are written
+Turning from rotation a to b tries the piece moved by offset i of a minus offset i of b for each i in turn,
+which gives the usual SRS wall kicks for clockwise and counter-clockwise turns
+SRS has no half turns; they only take the first test, turning the piece in place without kicks
+Row 0 - J, L, S, T, Z; row 1 - I; row 2 - O, which only uses its first offset to stay in place */
+constexpr int maxKicks = 5;
+constexpr cellOffset srsOffsets[3][numRotations][maxKicks] =
+{
+	{
+		{{ 0,  0}, { 0,  0}, { 0,  0}, { 0,  0}, { 0,  0}},
+		{{ 0,  0}, { 1,  0}, { 1, -1}, { 0,  2}, { 1,  2}},
+		{{ 0,  0}, { 0,  0}, { 0,  0}, { 0,  0}, { 0,  0}},
+		{{ 0,  0}, {-1,  0}, {-1, -1}, { 0,  2}, {-1,  2}}
+	},
+	{
+		{{ 0,  0}, {-1,  0}, { 2,  0}, {-1,  0}, { 2,  0}},
+		{{-1,  0}, { 0,  0}, { 0,  0}, { 0,  1}, { 0, -2}},
+		{{-1,  1}, { 1,  1}, {-2,  1}, { 1,  0}, {-2,  0}},
+		{{ 0,  1}, { 0,  1}, { 0,  1}, { 0, -1}, { 0,  2}}
+	},
+	{
+		{{ 0,  0}, { 0,  0}, { 0,  0}, { 0,  0}, { 0,  0}},
+		{{ 0, -1}, { 0, -1}, { 0, -1}, { 0, -1}, { 0, -1}},
+		{{-1, -1}, {-1, -1}, {-1, -1}, {-1, -1}, {-1, -1}},
+		{{-1,  0}, {-1,  0}, {-1,  0}, {-1,  0}, {-1,  0}}
+	}
+};
+
+//Board moves a turn tries in order, the first one the piece fits at being taken
+struct kickList
+{
+	cellOffset tests[maxKicks];
+	std::int8_t count;
+};
+
+//Kicks of every shape from every rotation, for a clockwise, half and counter-clockwise turn
+struct kickTable
+{
+	kickList lists[numShapes][numRotations][3];
+};
+
+//Works the kicks out from the SRS offsets, flipping them to the board's downward y and leaving out repeated tests,
+//which fail exactly when the same test before them did
+constexpr kickTable makeKickTable()
+{
+	kickTable table{};
+	for (int shape = 0; shape < numShapes; shape++)
+	{
+		int group = shape == 0 ? 1 : shape == 1 ? 2 : 0;
+		for (int rotation = 0; rotation < numRotations; rotation++)
+		{
+			for (int turns = 1; turns < numRotations; turns++)
+			{
+				kickList &list = table.lists[shape][rotation][turns - 1];
+				int target = (rotation + turns) % numRotations;
+				for (int i = 0; i < (turns == 2 ? 1 : maxKicks); i++)
+				{
+					cellOffset kick{};
+					kick.x = srsOffsets[group][rotation][i].x - srsOffsets[group][target][i].x;
+					kick.y = srsOffsets[group][target][i].y - srsOffsets[group][rotation][i].y;
+
+					bool repeated = false;
+					for (int j = 0; j < list.count; j++)
+					{
+						repeated = repeated || (list.tests[j].x == kick.x && list.tests[j].y == kick.y);
+					}
+					if (!repeated)
+					{
+						list.tests[list.count++] = kick;
+					}
+				}
+			}
+		}
+	}
+
+	return table;
+}
+
+constexpr kickTable kicks = makeKickTable();
+
+static_assert(kicks.lists[2][0][0].count == 5 && kicks.lists[2][0][0].tests[2].x == -1 && kicks.lists[2][0][0].tests[2].y == -1, "T spawn to clockwise kicks");
+static_assert(kicks.lists[0][0][0].tests[0].x == 1 && kicks.lists[0][0][0].tests[4].x == 2 && kicks.lists[0][0][0].tests[4].y == -2, "I spawn to clockwise kicks");
+static_assert(kicks.lists[1][0][0].count == 1 && kicks.lists[1][0][0].tests[0].y == -1, "O turns in place");
+
+//Returns the kicks of a shape turning from a rotation by a direction: 1 clockwise, -1 counter-clockwise, 2 half turn
+inline const kickList &returnKicks(int shape, int rotation, int direction)
+{
+	return kicks.lists[shape][rotation][(direction + numRotations) % numRotations - 1];
+}
+
+//Returns the precomputed layout of a shape in a rotation
+inline const pieceLayout &returnLayout(int shape, int rotation)
+{
+	return pieces.layouts[shape][rotation];
+}
+
+//Returns whether a piece of the given shape and rotation centered at (x, y) stays within the walls and the floor
+//without overlapping any filled cell of the board
+template <class boardType>
+inline bool pieceFits(const boardType &field, int shape, int rotation, int x, int y)
+{
+	typedef typename boardType::rowMask rowMask;
+	const pieceLayout &layout = returnLayout(shape, rotation);
+	int left = x + layout.minX;
+	if (left < 0 || left + layout.width > boardType::width)
+	{
+		return false;
+	}
+
+	for (int i = 0; i < layout.height; i++)
+	{
+		if (field.collides(rowMask(rowMask(layout.rowMasks[i]) << left), y + layout.minY + i))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+#endif
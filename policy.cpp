@@ -0,0 +1,65 @@
+#include <stdexcept>
+#include "policy.hpp"
+
+//Constructor setting the policy type and seeding its own generator, so a game's inputs only depend on its seed
+//The AI settings and search pool are only used by the AI policy
+inputPolicy::inputPolicy(policyType setType, unsigned seed, const aiOptions &setAiOptions, workStealingPool *searchPool) : type(setType), generator(seed)
+{
+	if (type == policyAi)
+	{
+		ai = std::make_shared<aiPlayer>(setAiOptions, searchPool);
+	}
+}
+
+//Returns the input to apply on the next step of the given game
+input inputPolicy::nextInput(const gameState &game)
+{
+	if (type == policyAi)
+	{
+		return ai->nextInput(game);
+	}
+
+	return nextBlindInput();
+}
+
+//Returns the input to apply on the next step without looking at the game, for games on any size of board
+//The AI policy needs to see the game, so it throws
+input inputPolicy::nextBlindInput()
+{
+	input in;
+	if (type == policyRandom)
+	{
+		in.flags = generator() & (inputLeft | inputRight | inputRotate | inputDown);
+	}
+	else if (type == policyAi)
+	{
+		throw std::runtime_error("The AI policy only plays on the standard board");
+	}
+
+	return in;
+}
+
+//Returns the AI player of the AI policy, null for the other policies
+const aiPlayer *inputPolicy::returnAi() const
+{
+	return ai.get();
+}
+
+//Returns the policy type with the given name
+policyType parsePolicy(const std::string &name)
+{
+	if (name == "idle")
+	{
+		return policyIdle;
+	}
+	else if (name == "random")
+	{
+		return policyRandom;
+	}
+	else if (name == "ai")
+	{
+		return policyAi;
+	}
+
+	throw std::runtime_error("Unknown policy " + name);
+}
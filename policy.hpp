@@ -0,0 +1,39 @@
+#ifndef POLICY_HPP
+#define POLICY_HPP
+
+#include <memory>
+#include <random>
+#include <string>
+#include "ai.hpp"
+#include "game.hpp"
+
+//Ways of choosing the input of a game without a player
+enum policyType
+{
+	//Never presses anything, so every tetromino drops straight down
+	policyIdle,
+	//Presses a random combination of keys every step
+	policyRandom,
+	//Searches for the best placement of every tetromino and steers it there
+	policyAi
+};
+
+//Chooses the input for every step of a headless game
+class inputPolicy
+{
+	private:
+		policyType type;
+		std::minstd_rand generator;
+		//Shared between copies of the policy, so only one copy should be used to play
+		std::shared_ptr<aiPlayer> ai;
+
+	public:
+		inputPolicy(policyType setType, unsigned seed, const aiOptions &setAiOptions = aiOptions(), workStealingPool *searchPool = nullptr);
+		input nextInput(const gameState &game);
+		input nextBlindInput();
+		const aiPlayer *returnAi() const;
+};
+
+policyType parsePolicy(const std::string &name);
+
+#endif
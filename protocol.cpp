@@ -0,0 +1,299 @@
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include "protocol.hpp"
+
+constexpr int bytesPerRow = (numColumns + 1) / 2;
+
+//Rebuilds the board of locked blocks the view shows
+board playerView::toBoard() const
+{
+	board field;
+	for (int y = 0; y < numRows; y++)
+	{
+		for (int x = 0; x < numColumns; x++)
+		{
+			std::uint8_t color = (rows[y][x >> 1] >> ((x & 1) * 4)) & 0xF;
+			if (color)
+			{
+				field.fillCell(x, y, color);
+			}
+		}
+	}
+	return field;
+}
+
+//Writes the hello a client opens with
+void writeHello(std::vector<std::uint8_t> &message)
+{
+	byteWriter out(message);
+	out.writeByte(messageHello);
+	out.writeVarint(protocolVersion);
+}
+
+//Reads a hello, throwing when the client speaks another version of the protocol
+void readHello(byteReader &in)
+{
+	if (in.readVarint() != protocolVersion)
+	{
+		throw std::runtime_error("Client speaks another protocol version");
+	}
+}
+
+//Writes the start of a match to one of its players
+void writeMatchStart(std::vector<std::uint8_t> &message, const matchInfo &info)
+{
+	byteWriter out(message);
+	out.writeByte(messageMatchStart);
+	out.writeByte(info.slot);
+	out.writeByte(info.numPlayers);
+	out.writeU32(info.seed);
+	writeRules(out, info.rules);
+}
+
+//Reads the start of a match
+matchInfo readMatchStart(byteReader &in)
+{
+	matchInfo info;
+	info.slot = in.readByte();
+	info.numPlayers = in.readByte();
+	info.seed = in.readU32();
+	info.rules = readRules(in);
+	if (info.numPlayers < 1 || info.numPlayers > maxPlayersPerMatch || info.slot >= info.numPlayers)
+	{
+		throw std::runtime_error("Invalid match start");
+	}
+
+	return info;
+}
+
+//Writes one input frame: the sequence number, the key flags and, only when a side key is set, the repeats
+void writeInputFrame(std::vector<std::uint8_t> &message, std::uint64_t sequence, input in)
+{
+	byteWriter out(message);
+	out.writeByte(messageInput);
+	out.writeVarint(sequence);
+	out.writeByte(in.flags);
+	if (in.flags & (inputLeft | inputRight))
+	{
+		out.writeByte(in.repeats);
+	}
+}
+
+//Reads an input frame written by writeInputFrame
+input readInputFrame(byteReader &in, std::uint64_t &sequence)
+{
+	input frame;
+	sequence = in.readVarint();
+	frame.flags = in.readByte();
+	if (frame.flags & (inputLeft | inputRight))
+	{
+		frame.repeats = in.readByte();
+	}
+	return frame;
+}
+
+/* Writes what changed in a player's game since the baseline and brings the baseline up to date
+After the header come, in the order of their flags, the changed rows as a mask followed by each of those rows packed
+two colors to a byte and the low 32 bits of the board hash; the active tetromino; the held shape and preview; the
+score, lines, level, combo and back-to-back; the incoming garbage; and whether the game is over
+Returns false and writes nothing when nothing changed */
+bool writeUpdate(std::vector<std::uint8_t> &message, int slot, std::uint64_t tick, std::uint64_t lastInput, const gameState &game, playerView &baseline)
+{
+	const board &field = game.returnBoard();
+	std::uint8_t rows[numRows][bytesPerRow];
+	std::uint32_t changedRows = 0;
+	for (int y = 0; y < numRows; y++)
+	{
+		for (int x = 0; x < numColumns; x += 2)
+		{
+			std::uint8_t high = x + 1 < numColumns ? field.returnColor(x + 1, y) : 0;
+			rows[y][x >> 1] = field.returnColor(x, y) | (high << 4);
+		}
+		if (std::memcmp(rows[y], baseline.rows[y], bytesPerRow) != 0)
+		{
+			changedRows |= 1u << y;
+		}
+	}
+
+	const tetromino &active = game.returnActive();
+	position p = active.returnPosition();
+	bool queueChanged = game.returnHeld() != baseline.held || game.returnPreviewCount() != baseline.previewCount;
+	for (int i = 0; i < game.returnPreviewCount() && !queueChanged; i++)
+	{
+		queueChanged = game.returnPreview(i) != baseline.preview[i];
+	}
+
+	std::uint8_t fields = 0;
+	fields |= changedRows ? updateRows : 0;
+	fields |= active.returnShape() != baseline.shape || active.returnRotation() != baseline.rotation || p.x != baseline.x || p.y != baseline.y ? updateActive : 0;
+	fields |= queueChanged ? updateQueue : 0;
+	fields |= game.returnScore() != baseline.score || game.returnLines() != baseline.lines || game.returnLevel() != baseline.level ? updateScore : 0;
+	fields |= game.returnCombo() != baseline.combo || game.returnBackToBack() != baseline.backToBack ? updateScore : 0;
+	fields |= game.returnPendingGarbage() != baseline.pendingGarbage ? updateGarbage : 0;
+	fields |= game.isGameOver() != baseline.gameOver ? updateOver : 0;
+	if (!fields)
+	{
+		return false;
+	}
+
+	byteWriter out(message);
+	out.writeByte(messageUpdate);
+	out.writeByte(slot);
+	out.writeVarint(tick);
+	out.writeVarint(lastInput);
+	out.writeByte(fields);
+	baseline.tick = tick;
+	baseline.lastInput = lastInput;
+
+	if (fields & updateRows)
+	{
+		out.writeVarint(changedRows);
+		for (int y = 0; y < numRows; y++)
+		{
+			if ((changedRows >> y) & 1)
+			{
+				out.writeBytes(rows[y], bytesPerRow);
+				std::memcpy(baseline.rows[y], rows[y], bytesPerRow);
+			}
+		}
+		baseline.boardHash = std::uint32_t(field.returnHash());
+		out.writeU32(baseline.boardHash);
+	}
+	if (fields & updateActive)
+	{
+		baseline.shape = active.returnShape();
+		baseline.rotation = active.returnRotation();
+		baseline.x = p.x;
+		baseline.y = p.y;
+		out.writeByte(baseline.shape | (baseline.rotation << 4));
+		out.writeSigned(baseline.x);
+		out.writeSigned(baseline.y);
+	}
+	if (fields & updateQueue)
+	{
+		baseline.held = game.returnHeld();
+		baseline.previewCount = game.returnPreviewCount();
+		out.writeSigned(baseline.held);
+		out.writeByte(baseline.previewCount);
+		for (int i = 0; i < baseline.previewCount; i++)
+		{
+			baseline.preview[i] = game.returnPreview(i);
+			out.writeByte(baseline.preview[i]);
+		}
+	}
+	if (fields & updateScore)
+	{
+		baseline.score = game.returnScore();
+		baseline.lines = game.returnLines();
+		baseline.level = game.returnLevel();
+		out.writeVarint(baseline.score);
+		out.writeVarint(baseline.lines);
+		out.writeVarint(baseline.level);
+		baseline.combo = game.returnCombo();
+		baseline.backToBack = game.returnBackToBack();
+		out.writeSigned(baseline.combo);
+		out.writeByte(baseline.backToBack);
+	}
+	if (fields & updateGarbage)
+	{
+		baseline.pendingGarbage = game.returnPendingGarbage();
+		out.writeVarint(baseline.pendingGarbage);
+	}
+	if (fields & updateOver)
+	{
+		baseline.gameOver = game.isGameOver();
+		out.writeByte(baseline.gameOver);
+	}
+
+	return true;
+}
+
+//Applies a board update to the view of the player it is for, out of numViews
+//Returns the slot of that player
+int readUpdate(byteReader &in, playerView *views, int numViews)
+{
+	int slot = in.readByte();
+	if (slot >= numViews)
+	{
+		throw std::runtime_error("Update for an invalid player");
+	}
+
+	playerView &view = views[slot];
+	view.tick = in.readVarint();
+	view.lastInput = in.readVarint();
+	std::uint8_t fields = in.readByte();
+	if (fields & updateRows)
+	{
+		std::uint64_t changedRows = in.readVarint();
+		if (changedRows >> numRows)
+		{
+			throw std::runtime_error("Update changes rows past the floor");
+		}
+		for (int y = 0; y < numRows; y++)
+		{
+			if ((changedRows >> y) & 1)
+			{
+				in.readBytes(view.rows[y], bytesPerRow);
+			}
+		}
+		view.boardHash = in.readU32();
+	}
+	if (fields & updateActive)
+	{
+		std::uint8_t packed = in.readByte();
+		view.shape = packed & 0xF;
+		view.rotation = packed >> 4;
+		view.x = in.readSigned();
+		view.y = in.readSigned();
+		if (view.shape >= numShapes || view.rotation >= numRotations)
+		{
+			throw std::runtime_error("Invalid tetromino in update");
+		}
+	}
+	if (fields & updateQueue)
+	{
+		view.held = in.readSigned();
+		view.previewCount = in.readByte();
+		if (view.held < -1 || view.held >= numShapes || view.previewCount > maxPreviewLength)
+		{
+			throw std::runtime_error("Invalid queue in update");
+		}
+		for (int i = 0; i < view.previewCount; i++)
+		{
+			view.preview[i] = in.readByte();
+		}
+	}
+	if (fields & updateScore)
+	{
+		view.score = in.readVarint();
+		view.lines = in.readVarint();
+		view.level = in.readVarint();
+		view.combo = int(in.readSigned());
+		view.backToBack = in.readByte();
+	}
+	if (fields & updateGarbage)
+	{
+		view.pendingGarbage = in.readVarint();
+	}
+	if (fields & updateOver)
+	{
+		view.gameOver = in.readByte();
+	}
+
+	return slot;
+}
+
+//Writes the end of a match
+void writeMatchEnd(std::vector<std::uint8_t> &message, int winner)
+{
+	byteWriter out(message);
+	out.writeByte(messageMatchEnd);
+	out.writeSigned(winner);
+}
+
+//Reads the end of a match, returning the slot of the winner or -1
+int readMatchEnd(byteReader &in)
+{
+	return int(in.readSigned());
+}
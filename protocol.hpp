@@ -0,0 +1,97 @@
+#ifndef PROTOCOL_HPP
+#define PROTOCOL_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "board.hpp"
+#include "game.hpp"
+#include "serial.hpp"
+
+/* Messages between the match server and its clients
+Every message starts with its type; the write functions write it and the read functions expect the caller to have
+read it already to choose which one to call. Input frames are a few bytes, and board updates are deltas against
+what the client was last sent, so a tick where only the active tetromino moved costs about ten bytes a player */
+
+//Version a client states in its hello, which the server must match
+constexpr int protocolVersion = 2;
+//Most players a match can have
+constexpr int maxPlayersPerMatch = 8;
+
+//Message types, the first byte of every message
+enum messageType : std::uint8_t
+{
+	//Client to server: protocol version; asks to be put in the next match
+	messageHello,
+	//Server to client: player slot, number of players, seed and rules of a match that starts
+	messageMatchStart,
+	//Client to server: sequence number and keys of one input frame
+	messageInput,
+	//Server to client: one player's game after a tick, as a delta against the last update of that player
+	messageUpdate,
+	//Server to client: slot of the winner of the match, -1 if nobody won
+	messageMatchEnd
+};
+
+//Parts of a player's game a board update carries, combined as bit flags
+enum updateField : std::uint8_t
+{
+	updateRows = 1,
+	updateActive = 2,
+	updateQueue = 4,
+	updateScore = 8,
+	updateGarbage = 16,
+	updateOver = 32
+};
+
+//What a client knows of one player's game, rebuilt from board updates
+//The server keeps one for every client and player as the baseline of the next update, so that an update only
+//carries the rows and fields that changed since the last one the client got
+struct playerView
+{
+	//Colors of the locked blocks, packed two to a byte the way gameState::save writes them
+	std::uint8_t rows[numRows][(numColumns + 1) / 2] = {};
+	int shape = -1;
+	int rotation = 0;
+	int x = 0;
+	int y = 0;
+	int held = -1;
+	int previewCount = 0;
+	int preview[maxPreviewLength] = {};
+	int score = 0;
+	int lines = 0;
+	int level = 0;
+	int combo = -1;
+	bool backToBack = false;
+	int pendingGarbage = 0;
+	bool gameOver = false;
+	//Low 32 bits of the Zobrist hash of the server's board, sent with every row change
+	std::uint32_t boardHash = 0;
+	//Server tick of the last update and sequence number of the last input frame the server applied
+	std::uint64_t tick = 0;
+	std::uint64_t lastInput = 0;
+
+	board toBoard() const;
+};
+
+//Settings of a match a client is told when it starts
+struct matchInfo
+{
+	int slot = 0;
+	int numPlayers = 0;
+	unsigned seed = 0;
+	gameRules rules;
+};
+
+void writeHello(std::vector<std::uint8_t> &message);
+void readHello(byteReader &in);
+void writeMatchStart(std::vector<std::uint8_t> &message, const matchInfo &info);
+matchInfo readMatchStart(byteReader &in);
+void writeInputFrame(std::vector<std::uint8_t> &message, std::uint64_t sequence, input in);
+input readInputFrame(byteReader &in, std::uint64_t &sequence);
+bool writeUpdate(std::vector<std::uint8_t> &message, int slot, std::uint64_t tick, std::uint64_t lastInput, const gameState &game, playerView &baseline);
+int readUpdate(byteReader &in, playerView *views, int numViews);
+void writeMatchEnd(std::vector<std::uint8_t> &message, int winner);
+int readMatchEnd(byteReader &in);
+
+#endif
@@ -0,0 +1,133 @@
+#include <algorithm>
+#include <stdexcept>
+#include "randomizer.hpp"
+
+//Constructor seeding the generator; every randomizer type uses the seed as is, so seeding a game costs two steps
+pieceRandomizer::pieceRandomizer(randomizerType setType, std::uint64_t seed) : type(setType), generator(seed)
+{
+	//The history starts full of S and Z, so the first pieces lean away from them
+	const std::uint8_t startHistory[historyLength] = {6, 5, 6, 5};
+	std::copy(startHistory, startHistory + historyLength, history);
+	for (int i = 0; i < numShapes; i++)
+	{
+		bag[i] = i;
+	}
+}
+
+//Returns the shape of the next tetromino
+int pieceRandomizer::next()
+{
+	int shape = 0;
+	if (type == randomizerBag)
+	{
+		//Fisher-Yates shuffle of a fresh bag once the last one is empty
+		if (bagLeft == 0)
+		{
+			for (int i = numShapes - 1; i > 0; i--)
+			{
+				std::swap(bag[i], bag[generator.nextBelow(i + 1)]);
+			}
+			bagLeft = numShapes;
+		}
+		shape = bag[numShapes - bagLeft];
+		bagLeft--;
+	}
+	else if (type == randomizerHistory)
+	{
+		//The first piece is never an S, Z or O, which would force an overhang
+		if (!dealtAny)
+		{
+			const int firstShapes[] = {0, 2, 3, 4};
+			shape = firstShapes[generator.nextBelow(4)];
+		}
+		else
+		{
+			for (int roll = 0; roll < historyRolls; roll++)
+			{
+				shape = generator.nextBelow(numShapes);
+				if (std::find(history, history + historyLength, shape) == history + historyLength)
+				{
+					break;
+				}
+			}
+		}
+
+		std::copy(history + 1, history + historyLength, history);
+		history[historyLength - 1] = shape;
+	}
+	else
+	{
+		shape = generator.nextBelow(numShapes);
+	}
+
+	dealtAny = true;
+	return shape;
+}
+
+//Returns how the randomizer chooses shapes
+randomizerType pieceRandomizer::returnType() const
+{
+	return type;
+}
+
+//Writes everything the next shapes depend on
+void pieceRandomizer::save(byteWriter &out) const
+{
+	out.writeByte(type);
+	generator.save(out);
+	out.writeBytes(bag, numShapes);
+	out.writeByte(bagLeft);
+	out.writeBytes(history, historyLength);
+	out.writeByte(dealtAny);
+}
+
+//Restores a randomizer written by save
+void pieceRandomizer::load(byteReader &in)
+{
+	type = randomizerType(in.readByte());
+	generator.load(in);
+	in.readBytes(bag, numShapes);
+	bagLeft = in.readByte();
+	in.readBytes(history, historyLength);
+	dealtAny = in.readByte();
+	if (type >= numRandomizers || bagLeft > numShapes)
+	{
+		throw std::runtime_error("Invalid randomizer in saved game");
+	}
+	for (int i = 0; i < numShapes; i++)
+	{
+		if (bag[i] >= numShapes)
+		{
+			throw std::runtime_error("Invalid randomizer in saved game");
+		}
+	}
+}
+
+//Returns the randomizer type with the given name
+randomizerType parseRandomizer(const std::string &name)
+{
+	for (int i = 0; i < numRandomizers; i++)
+	{
+		if (name == randomizerName(randomizerType(i)))
+		{
+			return randomizerType(i);
+		}
+	}
+
+	throw std::runtime_error("Unknown randomizer " + name);
+}
+
+//Returns the name of a randomizer type, as parseRandomizer takes it
+const char *randomizerName(randomizerType type)
+{
+	if (type == randomizerBag)
+	{
+		return "bag";
+	}
+	else if (type == randomizerHistory)
+	{
+		return "history";
+	}
+
+	return "classic";
+}
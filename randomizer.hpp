@@ -0,0 +1,109 @@
+#ifndef RANDOMIZER_HPP
+#define RANDOMIZER_HPP
+
+#include <cstdint>
+#include <string>
+#include "pieces.hpp"
+#include "serial.hpp"
+
+//PCG32 generator: 64 bits of state, 32 bit outputs, and the same sequence on every platform and standard library
+class pcg32
+{
+	private:
+		std::uint64_t state = 0;
+		std::uint64_t increment = 1;
+
+	public:
+		pcg32(std::uint64_t seed = 0, std::uint64_t stream = 0)
+		{
+			seedStream(seed, stream);
+		}
+
+		void seedStream(std::uint64_t seed, std::uint64_t stream)
+		{
+			state = 0;
+			increment = (stream << 1) | 1;
+			next();
+			state += seed;
+			next();
+		}
+
+		std::uint32_t next()
+		{
+			std::uint64_t old = state;
+			state = old * 6364136223846793005ull + increment;
+			std::uint32_t shifted = std::uint32_t(((old >> 18) ^ old) >> 27);
+			std::uint32_t rotation = std::uint32_t(old >> 59);
+			return (shifted >> rotation) | (shifted << ((32 - rotation) & 31));
+		}
+
+		//Uniform number in [0, bound) without modulo bias, by multiplying and rejecting the few biased results
+		std::uint32_t nextBelow(std::uint32_t bound)
+		{
+			std::uint64_t product = std::uint64_t(next()) * bound;
+			std::uint32_t low = std::uint32_t(product);
+			if (low < bound)
+			{
+				std::uint32_t threshold = (0u - bound) % bound;
+				while (low < threshold)
+				{
+					product = std::uint64_t(next()) * bound;
+					low = std::uint32_t(product);
+				}
+			}
+			return std::uint32_t(product >> 32);
+		}
+
+		void save(byteWriter &out) const
+		{
+			out.writeU64(state);
+			out.writeU64(increment);
+		}
+
+		void load(byteReader &in)
+		{
+			state = in.readU64();
+			increment = in.readU64() | 1;
+		}
+};
+
+//Ways of choosing the next tetromino
+enum randomizerType : std::uint8_t
+{
+	//Every shape equally likely every time
+	randomizerClassic,
+	//Deals the seven shapes in a shuffled order, then shuffles them again
+	randomizerBag,
+	//Rerolls shapes that are among the last few dealt, a few times at most
+	randomizerHistory,
+	numRandomizers
+};
+
+//Shapes the history randomizer remembers and how often it rerolls one of them
+constexpr int historyLength = 4;
+constexpr int historyRolls = 4;
+
+//Deals the sequence of tetromino shapes of a game from its seed
+class pieceRandomizer
+{
+	private:
+		randomizerType type;
+		pcg32 generator;
+		std::uint8_t bag[numShapes];
+		int bagLeft = 0;
+		std::uint8_t history[historyLength];
+		bool dealtAny = false;
+
+	public:
+		pieceRandomizer(randomizerType setType = randomizerClassic, std::uint64_t seed = 0);
+
+		int next();
+		randomizerType returnType() const;
+		void save(byteWriter &out) const;
+		void load(byteReader &in);
+};
+
+randomizerType parseRandomizer(const std::string &name);
+const char *randomizerName(randomizerType type);
+
+#endif
@@ -0,0 +1,199 @@
+#include <algorithm>
+#include "renderer.hpp"
+
+const sf::Color shapeColors[9] = {sf::Color::Black, sf::Color::Cyan, sf::Color::Yellow, sf::Color::Magenta, sf::Color::Blue, sf::Color::White, sf::Color::Green, sf::Color::Red, sf::Color(128, 128, 128)};
+
+//Constructor placing the top left corner of the board at (setOriginX, setOriginY) and drawing the empty board
+boardCanvas::boardCanvas(float setOriginX, float setOriginY, float setCellSize, float setLineWidth, sf::Color setLineColor) : originX(setOriginX), originY(setOriginY), cellSize(setCellSize), lineWidth(setLineWidth), lineColor(setLineColor), borders(sf::Quads), pending(sf::Quads), shown(sf::Quads)
+{
+	appendQuad(borders, 0, 0, lineWidth, numRows * cellSize, lineColor);
+	appendQuad(borders, lineWidth, numRows * cellSize, numColumns * cellSize, lineWidth, lineColor);
+
+	//Room for every cell with its lines so that adding cells never reallocates
+	pending.resize(16 * numColumns * numRows);
+	pending.clear();
+	shown.resize(16 * numColumns * numRows);
+	shown.clear();
+
+	useTexture = texture.create(numColumns * cellSize + lineWidth, numRows * cellSize + lineWidth);
+	if (useTexture)
+	{
+		for (int y = 0; y < numRows; y++)
+		{
+			for (int x = 0; x < numColumns; x++)
+			{
+				addCell(x, y, sf::Color::Black);
+			}
+		}
+		texture.clear(sf::Color::Black);
+		texture.draw(borders);
+		flush();
+		sprite.setTexture(texture.getTexture());
+		sprite.setPosition(originX - lineWidth, originY);
+	}
+}
+
+//Returns whether cells drawn once stay drawn, so that only changed cells need adding
+bool boardCanvas::returnIsPersistent() const
+{
+	return useTexture;
+}
+
+//Adds a cell at column x and row y of the board to redraw in a color, black when it is empty
+void boardCanvas::addCell(int x, int y, sf::Color fill)
+{
+	float left = lineWidth + x * cellSize;
+	float top = y * cellSize;
+	if (fill.a < 255)
+	{
+		appendQuad(pending, left, top, cellSize, cellSize, sf::Color::Black);
+	}
+	appendQuad(pending, left, top, cellSize, cellSize, fill);
+	appendQuad(pending, left, top, cellSize, lineWidth, lineColor);
+	appendQuad(pending, left + cellSize - lineWidth, top, lineWidth, cellSize, lineColor);
+}
+
+//Draws the cells added since the last flush into the texture, or keeps them to draw to the window
+void boardCanvas::flush()
+{
+	if (useTexture)
+	{
+		if (pending.getVertexCount() > 0)
+		{
+			texture.draw(pending);
+			texture.display();
+		}
+	}
+	else
+	{
+		shown.clear();
+		for (std::size_t i = 0; i < pending.getVertexCount(); i++)
+		{
+			shown.append(pending[i]);
+		}
+	}
+	pending.clear();
+}
+
+//Draws the board texture, or the cells and borders themselves without one
+void boardCanvas::draw(sf::RenderTarget &target, sf::RenderStates states) const
+{
+	if (useTexture)
+	{
+		target.draw(sprite, states);
+		return;
+	}
+
+	states.transform.translate(originX - lineWidth, originY);
+	target.draw(shown, states);
+	target.draw(borders, states);
+}
+
+//Adds the dirty cells of a view to a canvas, the ghost in a dimmed color of its shape and empty cells in black
+void addDirtyCells(boardCanvas &canvas, const boardView &view)
+{
+	for (int y = 0; y < numRows; y++)
+	{
+		for (std::uint32_t mask = view.returnDirtyRow(y); mask != 0; mask &= mask - 1)
+		{
+			int x = lowestSetBit(mask);
+			std::uint8_t cell = view.returnCell(x, y);
+			sf::Color fill = shapeColors[shownColor(cell)];
+			fill.a = isGhostCell(cell) ? 80 : 255;
+			canvas.addCell(x, y, fill);
+		}
+	}
+}
+
+//Appends an axis aligned rectangle of a single color to a quad array
+void appendQuad(sf::VertexArray &quads, float left, float top, float width, float height, sf::Color color)
+{
+	quads.append(sf::Vertex(sf::Vector2f(left, top), color));
+	quads.append(sf::Vertex(sf::Vector2f(left + width, top), color));
+	quads.append(sf::Vertex(sf::Vector2f(left + width, top + height), color));
+	quads.append(sf::Vertex(sf::Vector2f(left, top + height), color));
+}
+
+//Appends one quad per grid line of a board; vertical lines sit just left of their x coordinate like the rotated cell borders did
+void appendGrid(sf::VertexArray &quads, float originX, float originY, float cellSize, float lineWidth, sf::Color lineColor)
+{
+	float boardWidth = numColumns * cellSize;
+	float boardHeight = numRows * cellSize;
+	for (int i = 0; i <= numColumns; i++)
+	{
+		appendQuad(quads, originX + i * cellSize - lineWidth, originY, lineWidth, boardHeight, lineColor);
+	}
+	for (int j = 0; j <= numRows; j++)
+	{
+		appendQuad(quads, originX, originY + j * cellSize, boardWidth, lineWidth, lineColor);
+	}
+}
+
+//Appends a tetromino of the given shape in its spawn rotation with the top left of its bounding box at (left, top)
+void appendPiece(sf::VertexArray &quads, int shape, float left, float top, float cellSize)
+{
+	const pieceLayout &layout = returnLayout(shape, 0);
+	for (int i = 0; i < blocksPerPiece; i++)
+	{
+		const cellOffset &offset = layout.cells[i];
+		appendQuad(quads, left + (offset.x - layout.minX) * cellSize, top + (offset.y - layout.minY) * cellSize, cellSize, cellSize, shapeColors[shape + 1]);
+	}
+}
+
+//Appends a quad for every locked block and every block of the active tetromino of a game
+void appendGameFills(sf::VertexArray &quads, const gameState &game, float originX, float originY, float cellSize)
+{
+	const board &field = game.returnBoard();
+	for (int y = 0; y < numRows; y++)
+	{
+		//Only visit the set bits of each row
+		for (unsigned mask = field.returnRow(y); mask != 0; mask &= mask - 1)
+		{
+			int x = lowestSetBit(mask);
+			appendQuad(quads, originX + x * cellSize, originY + y * cellSize, cellSize, cellSize, shapeColors[field.returnColor(x, y)]);
+		}
+	}
+
+	for (int i = 0; i < blocksPerPiece; i++)
+	{
+		block activeBlock = game.returnActive().returnBlock(i);
+		position p = activeBlock.returnPosition();
+		if (p.y >= 0 && p.y < numRows)
+		{
+			appendQuad(quads, originX + p.x * cellSize, originY + p.y * cellSize, cellSize, cellSize, shapeColors[activeBlock.returnColor()]);
+		}
+	}
+}
+
+//Appends a row of bars per frame phase: the recent 99th percentile dimmed behind the median,
+//with the whole width standing for fullScale and longer times cut off at the edge
+void appendPhaseBars(sf::VertexArray &quads, const frameProfiler &profiler, float left, float top, float width, float rowHeight, std::chrono::nanoseconds fullScale)
+{
+	const sf::Color phaseColors[numPhases] = {sf::Color::Cyan, sf::Color::Green, sf::Color::Yellow, sf::Color::Magenta, sf::Color::Blue, sf::Color::White};
+	for (int phase = 0; phase < numPhases; phase++)
+	{
+		const latencyHistogram &timings = profiler.returnRecent(phase);
+		float y = top + phase * rowHeight;
+		float median = std::min(1.0, double(timings.returnPercentile(0.5)) / fullScale.count());
+		float tail = std::min(1.0, double(timings.returnPercentile(0.99)) / fullScale.count());
+		sf::Color dim = phaseColors[phase];
+		dim.a = 80;
+
+		appendQuad(quads, left, y, width, rowHeight - 2, sf::Color(40, 40, 40));
+		appendQuad(quads, left, y, width * tail, rowHeight - 2, dim);
+		appendQuad(quads, left, y, width * median, rowHeight - 2, phaseColors[phase]);
+	}
+}
+
+//Limits how often a window is redrawn, to the display refresh with vertical sync or to a fixed frame rate
+void configFrameRate(sf::RenderWindow &window, int frameLimit)
+{
+	if (frameLimit > 0)
+	{
+		window.setFramerateLimit(frameLimit);
+	}
+	else
+	{
+		window.setVerticalSyncEnabled(true);
+	}
+}
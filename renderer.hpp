@@ -0,0 +1,48 @@
+#ifndef RENDERER_HPP
+#define RENDERER_HPP
+
+#include <SFML/Graphics.hpp>
+#include "board.hpp"
+#include "boardView.hpp"
+#include "game.hpp"
+#include "instrument.hpp"
+
+//Colors of blocks indexed by their board color index, which is the shape ID + 1
+extern const sf::Color shapeColors[9];
+
+/* Draws a board into a render texture that keeps its pixels from frame to frame, so a frame only redraws the cells
+that changed: each one is covered with its fill and the two grid lines that run through it, the top and the right
+Where render textures are unsupported the board is drawn straight to the window, and every cell must be added
+every frame */
+class boardCanvas : public sf::Drawable
+{
+	private:
+		float originX, originY, cellSize, lineWidth;
+		sf::Color lineColor;
+		sf::RenderTexture texture;
+		sf::Sprite sprite;
+		bool useTexture;
+		//Left and bottom borders, which run through no cell; quads are in canvas coordinates, lineWidth right of the board's
+		sf::VertexArray borders;
+		sf::VertexArray pending;
+		sf::VertexArray shown;
+
+		void draw(sf::RenderTarget &target, sf::RenderStates states) const override;
+
+	public:
+		boardCanvas(float setOriginX, float setOriginY, float setCellSize, float setLineWidth, sf::Color setLineColor = sf::Color::White);
+
+		bool returnIsPersistent() const;
+		void addCell(int x, int y, sf::Color fill);
+		void flush();
+};
+
+void addDirtyCells(boardCanvas &canvas, const boardView &view);
+void appendQuad(sf::VertexArray &quads, float left, float top, float width, float height, sf::Color color);
+void appendGrid(sf::VertexArray &quads, float originX, float originY, float cellSize, float lineWidth, sf::Color lineColor);
+void appendPiece(sf::VertexArray &quads, int shape, float left, float top, float cellSize);
+void appendGameFills(sf::VertexArray &quads, const gameState &game, float originX, float originY, float cellSize);
+void appendPhaseBars(sf::VertexArray &quads, const frameProfiler &profiler, float left, float top, float width, float rowHeight, std::chrono::nanoseconds fullScale);
+void configFrameRate(sf::RenderWindow &window, int frameLimit);
+
+#endif
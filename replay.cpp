@@ -0,0 +1,354 @@
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include "replay.hpp"
+
+//Writes the run of identical inputs appended so far
+void inputStreamWriter::flushRun()
+{
+	if (runLength == 0)
+	{
+		return;
+	}
+
+	byteWriter out(bytes);
+	out.writeVarint(runInput.flags | (runInput.repeats << 8));
+	out.writeVarint(runLength - 1);
+	runLength = 0;
+}
+
+//Appends the input of the next step
+void inputStreamWriter::append(input in)
+{
+	if (runLength > 0 && (in.flags != runInput.flags || in.repeats != runInput.repeats))
+	{
+		flushRun();
+	}
+
+	runInput = in;
+	runLength++;
+}
+
+//Writes the open run and returns the whole stream
+const std::vector<std::uint8_t> &inputStreamWriter::finish()
+{
+	flushRun();
+	return bytes;
+}
+
+//Returns where the run that is still open will be written
+std::size_t inputStreamWriter::returnOpenRunOffset() const
+{
+	return bytes.size();
+}
+
+//Returns the number of steps in the run that is still open
+std::uint64_t inputStreamWriter::returnOpenRunLength() const
+{
+	return runLength;
+}
+
+//Empties the stream, keeping its memory for the next one
+void inputStreamWriter::clear()
+{
+	bytes.clear();
+	runLength = 0;
+}
+
+//Constructor reading the stream from its first run
+inputStreamReader::inputStreamReader(const std::uint8_t *setData, std::size_t setSize) : data(setData), size(setSize)
+{
+}
+
+//Returns the input of the next step
+input inputStreamReader::next()
+{
+	if (runLeft == 0)
+	{
+		if (offset >= size)
+		{
+			throw std::runtime_error("Input stream ends before the last tick");
+		}
+
+		byteReader in(data, size);
+		in.seek(offset);
+		std::uint64_t packed = in.readVarint();
+		runInput.flags = packed & 0xFF;
+		runInput.repeats = (packed >> 8) & 0xFF;
+		runLeft = in.readVarint() + 1;
+		offset = in.returnOffset();
+	}
+
+	runLeft--;
+	return runInput;
+}
+
+//Moves to the step that is ticksIntoRun steps into the run starting at runOffset
+void inputStreamReader::seek(std::size_t runOffset, std::uint64_t ticksIntoRun)
+{
+	offset = runOffset;
+	runLeft = 0;
+	for (std::uint64_t i = 0; i < ticksIntoRun; i++)
+	{
+		next();
+	}
+}
+
+//Constructor starting an empty recording of a game created with the given seed and rules
+replayRecorder::replayRecorder(unsigned setSeed, const gameRules &setRules, int setCheckpointInterval) : seed(setSeed), rules(setRules), checkpointInterval(setCheckpointInterval > 0 ? setCheckpointInterval : defaultCheckpointInterval)
+{
+}
+
+//Records the input of the next step, saving a checkpoint of the game first when one is due
+void replayRecorder::record(const gameState &game, input in)
+{
+	if (tickCount % checkpointInterval == 0)
+	{
+		//A checkpoint always starts a run, so its tick is the first of the run written at the current end of the stream
+		inputs.finish();
+		replayCheckpoint checkpoint;
+		checkpoint.tick = tickCount;
+		checkpoint.inputOffset = inputs.returnOpenRunOffset();
+		checkpoint.ticksIntoRun = 0;
+		byteWriter stateOut(checkpoint.state);
+		game.save(stateOut);
+		checkpoints.push_back(checkpoint);
+	}
+
+	inputs.append(in);
+	tickCount++;
+}
+
+//Returns the whole replay file
+std::vector<std::uint8_t> replayRecorder::finish()
+{
+	const std::vector<std::uint8_t> &inputBytes = inputs.finish();
+
+	std::vector<std::uint8_t> bytes;
+	byteWriter out(bytes);
+	out.writeU32(replayMagic);
+	out.writeU16(replayVersion);
+	out.writeU16(0);
+	out.writeU32(seed);
+	writeRules(out, rules);
+	out.writeVarint(tickCount);
+	out.writeVarint(checkpointInterval);
+	out.writeVarint(inputBytes.size());
+	out.writeBytes(inputBytes.data(), inputBytes.size());
+	out.writeVarint(checkpoints.size());
+	for (int i = 0; i < checkpoints.size(); i++)
+	{
+		out.writeVarint(checkpoints[i].tick);
+		out.writeVarint(checkpoints[i].inputOffset);
+		out.writeVarint(checkpoints[i].ticksIntoRun);
+		out.writeVarint(checkpoints[i].state.size());
+		out.writeBytes(checkpoints[i].state.data(), checkpoints[i].state.size());
+	}
+
+	return bytes;
+}
+
+//Writes the replay file to disk
+void replayRecorder::saveToFile(const std::string &path)
+{
+	writeFileBytes(path, finish());
+}
+
+//Returns the number of steps recorded
+std::uint64_t replayRecorder::returnTickCount() const
+{
+	return tickCount;
+}
+
+//Constructor parsing a replay file and starting its game at tick 0
+replayPlayer::replayPlayer(const std::vector<std::uint8_t> &bytes) : data(bytes), game(0), inputs(nullptr, 0)
+{
+	byteReader in(data.data(), data.size());
+	if (in.readU32() != replayMagic)
+	{
+		throw std::runtime_error("Not a replay file");
+	}
+	if (in.readU16() != replayVersion)
+	{
+		throw std::runtime_error("Unsupported replay version");
+	}
+	in.readU16();
+
+	seed = in.readU32();
+	rules = readRules(in);
+	tickCount = in.readVarint();
+	in.readVarint();
+	inputsSize = in.readVarint();
+	inputsBegin = in.returnOffset();
+	in.seek(inputsBegin + inputsSize);
+
+	std::uint64_t numCheckpoints = in.readVarint();
+	for (std::uint64_t i = 0; i < numCheckpoints; i++)
+	{
+		replayCheckpoint checkpoint;
+		checkpoint.tick = in.readVarint();
+		checkpoint.inputOffset = in.readVarint();
+		checkpoint.ticksIntoRun = in.readVarint();
+		checkpoint.state.resize(in.readVarint());
+		in.readBytes(checkpoint.state.data(), checkpoint.state.size());
+		if (checkpoint.inputOffset > inputsSize)
+		{
+			throw std::runtime_error("Checkpoint past the end of the input stream");
+		}
+		checkpoints.push_back(checkpoint);
+	}
+
+	restartFromBeginning();
+}
+
+//Starts the recorded game over from tick 0
+void replayPlayer::restartFromBeginning()
+{
+	game = gameState(seed, rules);
+	tick = 0;
+	inputs = inputStreamReader(data.data() + inputsBegin, inputsSize);
+}
+
+//Returns the number of recorded steps
+std::uint64_t replayPlayer::returnTickCount() const
+{
+	return tickCount;
+}
+
+//Returns the number of steps played so far
+std::uint64_t replayPlayer::returnTick() const
+{
+	return tick;
+}
+
+//Returns the seed the recorded game was created with
+unsigned replayPlayer::returnSeed() const
+{
+	return seed;
+}
+
+//Returns the rules the recorded game was played with
+const gameRules &replayPlayer::returnRules() const
+{
+	return rules;
+}
+
+//Returns the first byte of the encoded input stream
+const std::uint8_t *replayPlayer::returnInputData() const
+{
+	return data.data() + inputsBegin;
+}
+
+//Returns the size of the encoded input stream in bytes
+std::size_t replayPlayer::returnInputSize() const
+{
+	return inputsSize;
+}
+
+//Returns the game as of the current tick
+const gameState &replayPlayer::returnGame() const
+{
+	return game;
+}
+
+//Returns every checkpoint in the replay
+const std::vector<replayCheckpoint> &replayPlayer::returnCheckpoints() const
+{
+	return checkpoints;
+}
+
+//Plays the next recorded step, returning false once every step has been played
+bool replayPlayer::stepForward()
+{
+	if (tick >= tickCount)
+	{
+		return false;
+	}
+
+	game.step(inputs.next());
+	if (game.isGameOver())
+	{
+		game.restart();
+	}
+	tick++;
+	return true;
+}
+
+//Moves to the start of the target tick by restoring the closest checkpoint before it and playing forward from there
+void replayPlayer::seek(std::uint64_t target)
+{
+	if (target > tickCount)
+	{
+		target = tickCount;
+	}
+
+	//Checkpoints are in tick order; going back without one means starting over from tick 0
+	int closest = -1;
+	for (int i = 0; i < checkpoints.size() && checkpoints[i].tick <= target; i++)
+	{
+		closest = i;
+	}
+
+	if (closest >= 0 && (target < tick || checkpoints[closest].tick > tick))
+	{
+		const replayCheckpoint &checkpoint = checkpoints[closest];
+		byteReader in(checkpoint.state.data(), checkpoint.state.size());
+		game.load(in);
+		tick = checkpoint.tick;
+		inputs.seek(checkpoint.inputOffset, checkpoint.ticksIntoRun);
+	}
+	else if (target < tick)
+	{
+		restartFromBeginning();
+	}
+
+	while (tick < target && stepForward())
+	{
+	}
+}
+
+//Plays the replay from the start and compares the game with every checkpoint on the way
+//Returns the tick of the first checkpoint that does not match, or -1 if the replay is deterministic
+std::int64_t replayPlayer::findDivergence()
+{
+	restartFromBeginning();
+	for (int i = 0; i < checkpoints.size(); i++)
+	{
+		while (tick < checkpoints[i].tick && stepForward())
+		{
+		}
+
+		std::vector<std::uint8_t> state;
+		byteWriter out(state);
+		game.save(out);
+		if (state != checkpoints[i].state)
+		{
+			return checkpoints[i].tick;
+		}
+	}
+
+	return -1;
+}
+
+//Returns the contents of a file
+std::vector<std::uint8_t> readFileBytes(const std::string &path)
+{
+	std::ifstream file(path, std::ios::binary);
+	if (!file)
+	{
+		throw std::runtime_error("Could not open " + path);
+	}
+
+	return std::vector<std::uint8_t>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+//Replaces the contents of a file
+void writeFileBytes(const std::string &path, const std::vector<std::uint8_t> &bytes)
+{
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+	file.write(reinterpret_cast<const char *>(bytes.data()), bytes.size());
+	if (!file)
+	{
+		throw std::runtime_error("Could not write " + path);
+	}
+}
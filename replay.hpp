@@ -0,0 +1,131 @@
+#ifndef REPLAY_HPP
+#define REPLAY_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "game.hpp"
+#include "serial.hpp"
+
+/* Replay file layout, integers little endian and varints LEB128
+u32 magic "TTRP", u16 version, u16 reserved
+u32 seed, rules: gravity table of numLevels bytes, u8 randomizer, u8 preview length, u8 lock delay
+varint tick count, varint checkpoint interval
+varint input stream size, input stream: one (varint flags | repeats << 8, varint run length - 1) pair per run of identical inputs
+varint checkpoint count, per checkpoint: varint tick, varint input offset, varint ticks into run, varint state size, state */
+constexpr std::uint32_t replayMagic = 0x50525454;
+//Version 3 records the randomizer and preview length, and checkpoints hold the preview queue and hold slot
+//Version 4 games turn with SRS orientations and kicks and record their lock delay
+//Version 5 inputs carry auto repeated side moves
+//Version 6 checkpoints hold the combo, back-to-back and incoming garbage
+//Version 7 checkpoints hold the lowest row and lock delay restarts of the active tetromino
+//Version 8 games are lost as soon as a tetromino spawns overlapping the stack
+constexpr std::uint16_t replayVersion = 8;
+//One checkpoint every 10 seconds of play
+constexpr int defaultCheckpointInterval = 10 * ticksPerSecond;
+
+//Appends step inputs to an input stream, merging runs of identical inputs
+class inputStreamWriter
+{
+	private:
+		std::vector<std::uint8_t> bytes;
+		input runInput;
+		std::uint64_t runLength = 0;
+
+		void flushRun();
+
+	public:
+		void append(input in);
+		const std::vector<std::uint8_t> &finish();
+		std::size_t returnOpenRunOffset() const;
+		std::uint64_t returnOpenRunLength() const;
+		void clear();
+};
+
+//Decodes an input stream one step at a time, reading it in place
+class inputStreamReader
+{
+	private:
+		const std::uint8_t *data;
+		std::size_t size;
+		std::size_t offset = 0;
+		input runInput;
+		std::uint64_t runLeft = 0;
+
+	public:
+		inputStreamReader(const std::uint8_t *setData, std::size_t setSize);
+
+		input next();
+		void seek(std::size_t runOffset, std::uint64_t ticksIntoRun);
+};
+
+//Saved game state at the start of a tick and where that tick's input sits in the input stream
+struct replayCheckpoint
+{
+	std::uint64_t tick;
+	std::uint64_t inputOffset;
+	std::uint64_t ticksIntoRun;
+	std::vector<std::uint8_t> state;
+};
+
+//Records the input of every step of a game and periodic checkpoints of its state
+//record must be called with the game and input right before every call to step
+class replayRecorder
+{
+	private:
+		unsigned seed;
+		gameRules rules;
+		int checkpointInterval;
+		inputStreamWriter inputs;
+		std::vector<replayCheckpoint> checkpoints;
+		std::uint64_t tickCount = 0;
+
+	public:
+		replayRecorder(unsigned setSeed, const gameRules &setRules = gameRules(), int setCheckpointInterval = defaultCheckpointInterval);
+
+		void record(const gameState &game, input in);
+		std::vector<std::uint8_t> finish();
+		void saveToFile(const std::string &path);
+		std::uint64_t returnTickCount() const;
+};
+
+//Re-simulates a recorded game headlessly, as fast as the engine runs
+//Lost games start over, as they do in the window the replay was recorded in
+class replayPlayer
+{
+	private:
+		std::vector<std::uint8_t> data;
+		unsigned seed;
+		gameRules rules;
+		std::uint64_t tickCount;
+		std::size_t inputsBegin;
+		std::size_t inputsSize;
+		std::vector<replayCheckpoint> checkpoints;
+
+		gameState game;
+		std::uint64_t tick = 0;
+		inputStreamReader inputs;
+
+		void restartFromBeginning();
+
+	public:
+		replayPlayer(const std::vector<std::uint8_t> &bytes);
+
+		std::uint64_t returnTickCount() const;
+		std::uint64_t returnTick() const;
+		unsigned returnSeed() const;
+		const gameRules &returnRules() const;
+		const std::uint8_t *returnInputData() const;
+		std::size_t returnInputSize() const;
+		const gameState &returnGame() const;
+		const std::vector<replayCheckpoint> &returnCheckpoints() const;
+
+		bool stepForward();
+		void seek(std::uint64_t target);
+		std::int64_t findDivergence();
+};
+
+std::vector<std::uint8_t> readFileBytes(const std::string &path);
+void writeFileBytes(const std::string &path, const std::vector<std::uint8_t> &bytes);
+
+#endif
@@ -0,0 +1,93 @@
+#include <chrono>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include "replay.hpp"
+
+//Prints how to call the replay player
+void printUsage()
+{
+	std::cerr << "Usage: tetris_replay <file> [--seek tick] [--verify]\n";
+}
+
+//Prints the state of the replayed game
+void printGame(const replayPlayer &player)
+{
+	const gameState &game = player.returnGame();
+	std::cout << "tick         " << player.returnTick() << " of " << player.returnTickCount() << "\n";
+	std::cout << "score        " << game.returnScore() << "\n";
+	std::cout << "lines        " << game.returnLines() << "\n";
+	std::cout << "pieces       " << game.returnPiecesPlaced() << "\n";
+	std::cout << "level        " << game.returnLevel() << "\n";
+}
+
+int main(int argc, char **argv)
+{
+	if (argc < 2)
+	{
+		printUsage();
+		return 1;
+	}
+
+	try
+	{
+		std::string path = argv[1];
+		bool verify = false;
+		bool hasSeek = false;
+		std::uint64_t seekTick = 0;
+		for (int i = 2; i < argc; i++)
+		{
+			std::string arg = argv[i];
+			if (arg == "--verify")
+			{
+				verify = true;
+			}
+			else if (arg == "--seek" && i + 1 < argc)
+			{
+				seekTick = std::stoull(argv[++i]);
+				hasSeek = true;
+			}
+			else
+			{
+				throw std::runtime_error("Unknown option " + arg);
+			}
+		}
+
+		replayPlayer player(readFileBytes(path));
+		std::cout << "seed         " << player.returnSeed() << "\n";
+		std::cout << "checkpoints  " << player.returnCheckpoints().size() << "\n";
+
+		if (verify)
+		{
+			std::int64_t divergence = player.findDivergence();
+			if (divergence >= 0)
+			{
+				std::cout << "replay diverges from its checkpoint at tick " << divergence << "\n";
+				return 2;
+			}
+			std::cout << "every checkpoint matches\n";
+		}
+
+		auto start = std::chrono::steady_clock::now();
+		if (hasSeek)
+		{
+			player.seek(seekTick);
+		}
+		else
+		{
+			player.seek(0);
+			while (player.stepForward())
+			{
+			}
+		}
+		double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		printGame(player);
+		std::cout << "reached in   " << seconds << " s for " << player.returnTick() / double(ticksPerSecond) << " s of play\n";
+	}
+	catch(std::exception const &e)
+	{
+		std::cerr << "Exception: " << e.what() << "\n";
+		return 1;
+	}
+}
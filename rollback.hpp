@@ -0,0 +1,84 @@
+#ifndef ROLLBACK_HPP
+#define ROLLBACK_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include "game.hpp"
+
+//Last capacity ticks of a game, each kept as the state the game was in before the tick and the input it was stepped with
+//Online play steps the game on predicted remote input; when the real input of an earlier tick arrives and differs,
+//correct copies the game back from that tick's snapshot and steps it forward again to the current tick
+//Snapshots are the bytes of the game, which is trivially copyable, so saving or restoring one is a single memcpy that
+//never allocates; capacity must be a power of two
+template <typename state, std::size_t capacity>
+class rollbackRing
+{
+	private:
+		static_assert(capacity > 0 && (capacity & (capacity - 1)) == 0, "Capacity must be a power of two");
+		static_assert(std::is_trivially_copyable<state>::value, "Snapshots are plain copies of the game");
+
+		struct snapshot
+		{
+			alignas(state) unsigned char game[sizeof(state)];
+			input in;
+		};
+
+		snapshot snapshots[capacity];
+		//Ticks stepped so far; the snapshot of tick t is at t & (capacity - 1) while t is one of the last capacity ticks
+		std::uint64_t tick = 0;
+
+	public:
+		//Steps the game by one tick with an input, keeping the state it was in beforehand
+		stepResult advance(state &game, input in)
+		{
+			snapshot &saved = snapshots[tick & (capacity - 1)];
+			std::memcpy(saved.game, &game, sizeof(state));
+			saved.in = in;
+			tick++;
+			return game.step(in);
+		}
+
+		//Returns whether the snapshot of an earlier tick is still kept
+		bool canRollBack(std::uint64_t earlier) const
+		{
+			return earlier < tick && tick - earlier <= capacity;
+		}
+
+		//Replaces the input of an earlier tick and steps the game again from that tick's snapshot to the current tick,
+		//keeping the snapshots of the ticks after it up to date
+		//Returns the number of ticks stepped again, -1 when the tick is older than the oldest snapshot
+		int correct(state &game, std::uint64_t earlier, input in)
+		{
+			if (!canRollBack(earlier))
+			{
+				return -1;
+			}
+
+			snapshots[earlier & (capacity - 1)].in = in;
+			std::memcpy(&game, snapshots[earlier & (capacity - 1)].game, sizeof(state));
+			game.step(snapshots[earlier & (capacity - 1)].in);
+			for (std::uint64_t t = earlier + 1; t < tick; t++)
+			{
+				snapshot &saved = snapshots[t & (capacity - 1)];
+				std::memcpy(saved.game, &game, sizeof(state));
+				game.step(saved.in);
+			}
+			return int(tick - earlier);
+		}
+
+		//Returns the input a tick was last stepped with
+		input returnInput(std::uint64_t earlier) const
+		{
+			return snapshots[earlier & (capacity - 1)].in;
+		}
+
+		//Returns the number of ticks stepped
+		std::uint64_t returnTick() const
+		{
+			return tick;
+		}
+};
+
+#endif
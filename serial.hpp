@@ -0,0 +1,196 @@
+#ifndef SERIAL_HPP
+#define SERIAL_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+//Appends little endian integers, LEB128 varints and strings to a byte buffer
+class byteWriter
+{
+	private:
+		std::vector<std::uint8_t> &bytes;
+
+	public:
+		byteWriter(std::vector<std::uint8_t> &setBytes) : bytes(setBytes)
+		{
+		}
+
+		void writeByte(std::uint8_t value)
+		{
+			bytes.push_back(value);
+		}
+
+		void writeU16(std::uint16_t value)
+		{
+			writeByte(value & 0xFF);
+			writeByte(value >> 8);
+		}
+
+		void writeU32(std::uint32_t value)
+		{
+			for (int i = 0; i < 4; i++)
+			{
+				writeByte((value >> (8 * i)) & 0xFF);
+			}
+		}
+
+		void writeU64(std::uint64_t value)
+		{
+			for (int i = 0; i < 8; i++)
+			{
+				writeByte((value >> (8 * i)) & 0xFF);
+			}
+		}
+
+		//Seven bits per byte, lowest first, with the top bit set on every byte but the last
+		void writeVarint(std::uint64_t value)
+		{
+			while (value >= 0x80)
+			{
+				writeByte(std::uint8_t(value) | 0x80);
+				value >>= 7;
+			}
+			writeByte(std::uint8_t(value));
+		}
+
+		//Zigzag encoding keeps small negative numbers small
+		void writeSigned(std::int64_t value)
+		{
+			writeVarint((std::uint64_t(value) << 1) ^ std::uint64_t(value >> 63));
+		}
+
+		void writeBytes(const void *data, std::size_t size)
+		{
+			const std::uint8_t *first = static_cast<const std::uint8_t *>(data);
+			bytes.insert(bytes.end(), first, first + size);
+		}
+
+		void writeString(const std::string &value)
+		{
+			writeVarint(value.size());
+			writeBytes(value.data(), value.size());
+		}
+};
+
+//Reads back what a byteWriter wrote, throwing when the data runs out
+class byteReader
+{
+	private:
+		const std::uint8_t *data;
+		std::size_t size;
+		std::size_t offset = 0;
+
+	public:
+		byteReader(const std::uint8_t *setData, std::size_t setSize) : data(setData), size(setSize)
+		{
+		}
+
+		std::uint8_t readByte()
+		{
+			if (offset >= size)
+			{
+				throw std::runtime_error("Data truncated");
+			}
+			return data[offset++];
+		}
+
+		std::uint16_t readU16()
+		{
+			std::uint16_t low = readByte();
+			return low | (std::uint16_t(readByte()) << 8);
+		}
+
+		std::uint32_t readU32()
+		{
+			std::uint32_t value = 0;
+			for (int i = 0; i < 4; i++)
+			{
+				value |= std::uint32_t(readByte()) << (8 * i);
+			}
+			return value;
+		}
+
+		std::uint64_t readU64()
+		{
+			std::uint64_t value = 0;
+			for (int i = 0; i < 8; i++)
+			{
+				value |= std::uint64_t(readByte()) << (8 * i);
+			}
+			return value;
+		}
+
+		std::uint64_t readVarint()
+		{
+			std::uint64_t value = 0;
+			for (int shift = 0; shift < 64; shift += 7)
+			{
+				std::uint8_t next = readByte();
+				value |= std::uint64_t(next & 0x7F) << shift;
+				if (!(next & 0x80))
+				{
+					return value;
+				}
+			}
+			throw std::runtime_error("Varint too long");
+		}
+
+		std::int64_t readSigned()
+		{
+			std::uint64_t value = readVarint();
+			return std::int64_t(value >> 1) ^ -std::int64_t(value & 1);
+		}
+
+		void readBytes(void *out, std::size_t count)
+		{
+			if (count > size - offset)
+			{
+				throw std::runtime_error("Data truncated");
+			}
+			std::uint8_t *first = static_cast<std::uint8_t *>(out);
+			std::copy(data + offset, data + offset + count, first);
+			offset += count;
+		}
+
+		std::string readString()
+		{
+			std::uint64_t length = readVarint();
+			if (length > size - offset)
+			{
+				throw std::runtime_error("Data truncated");
+			}
+			std::string value(reinterpret_cast<const char *>(data + offset), length);
+			offset += length;
+			return value;
+		}
+
+		const std::uint8_t *returnCursor() const
+		{
+			return data + offset;
+		}
+
+		std::size_t returnOffset() const
+		{
+			return offset;
+		}
+
+		void seek(std::size_t setOffset)
+		{
+			if (setOffset > size)
+			{
+				throw std::runtime_error("Seek past the end of the data");
+			}
+			offset = setOffset;
+		}
+
+		bool atEnd() const
+		{
+			return offset >= size;
+		}
+};
+
+#endif
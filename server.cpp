@@ -0,0 +1,482 @@
+#include <algorithm>
+#include <cerrno>
+#include <stdexcept>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+#include "instrument.hpp"
+#include "server.hpp"
+
+//Most ticks run at once when the server wakes up late; the rest are dropped rather than run in a burst
+constexpr std::uint64_t maxCatchUpTicks = 4;
+
+//Constructor listening on the address and setting up the epoll loop, its tick timer and its wake up event
+matchServer::matchServer(const serverOptions &setOptions) : options(setOptions)
+{
+	if (options.playersPerMatch < 1 || options.playersPerMatch > maxPlayersPerMatch || options.tickRate < 1)
+	{
+		throw std::runtime_error("Invalid server options");
+	}
+
+	listenFd = listenSocket(options.address);
+	epollFd = epoll_create1(EPOLL_CLOEXEC);
+	timerFd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+	wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if (epollFd < 0 || timerFd < 0 || wakeFd < 0)
+	{
+		closeAll();
+		throw std::runtime_error("Could not set up the server's event loop");
+	}
+
+	watch(listenFd, EPOLLIN, true);
+	watch(timerFd, EPOLLIN, true);
+	watch(wakeFd, EPOLLIN, true);
+}
+
+//Destructor closing every connection and removing the Unix socket
+matchServer::~matchServer()
+{
+	closeAll();
+}
+
+//Closes the connections and the event loop, and removes the Unix socket if the server listens on one
+void matchServer::closeAll()
+{
+	clients.clear();
+	const int fds[] = {listenFd, epollFd, timerFd, wakeFd};
+	for (int fd : fds)
+	{
+		if (fd >= 0)
+		{
+			close(fd);
+		}
+	}
+	listenFd = epollFd = timerFd = wakeFd = -1;
+	if (options.address.compare(0, 5, "unix:") == 0)
+	{
+		unlink(options.address.c_str() + 5);
+	}
+}
+
+//Adds a file descriptor to the epoll set or changes the events it is watched for
+void matchServer::watch(int fd, std::uint32_t events, bool add)
+{
+	epoll_event event = {};
+	event.events = events;
+	event.data.fd = fd;
+	if (epoll_ctl(epollFd, add ? EPOLL_CTL_ADD : EPOLL_CTL_MOD, fd, &event) != 0)
+	{
+		throw std::runtime_error("Could not watch a socket");
+	}
+}
+
+//Runs the event loop until stop is called: accepting clients, reading their messages and ticking every match at the tick rate
+void matchServer::run()
+{
+	std::int64_t period = 1000000000 / options.tickRate;
+	itimerspec interval = {};
+	interval.it_interval.tv_sec = period / 1000000000;
+	interval.it_interval.tv_nsec = period % 1000000000;
+	interval.it_value = interval.it_interval;
+	timerfd_settime(timerFd, 0, &interval, nullptr);
+
+	epoll_event events[64];
+	while (!stopping.load(std::memory_order_relaxed))
+	{
+		int count = epoll_wait(epollFd, events, 64, -1);
+		if (count < 0)
+		{
+			if (errno == EINTR)
+			{
+				continue;
+			}
+			throw std::runtime_error("Event loop failed");
+		}
+
+		for (int i = 0; i < count; i++)
+		{
+			int fd = events[i].data.fd;
+			if (fd == listenFd)
+			{
+				acceptClients();
+			}
+			else if (fd == timerFd)
+			{
+				std::uint64_t expirations = 0;
+				if (read(timerFd, &expirations, sizeof(expirations)) == sizeof(expirations))
+				{
+					std::uint64_t due = std::min(expirations, maxCatchUpTicks);
+					stats.droppedTicks += expirations - due;
+					for (std::uint64_t tick = 0; tick < due; tick++)
+					{
+						runTick();
+					}
+					for (auto &entry : clients)
+					{
+						flushClient(entry.first, entry.second);
+					}
+				}
+			}
+			else if (fd == wakeFd)
+			{
+				std::uint64_t wakes;
+				read(wakeFd, &wakes, sizeof(wakes));
+			}
+			else
+			{
+				handleClient(fd, events[i].events);
+			}
+		}
+
+		//Clients whose connection failed while being flushed are dropped here, outside the loops over them
+		for (auto entry = clients.begin(); entry != clients.end(); )
+		{
+			int fd = entry->first;
+			bool failed = entry->second.failed;
+			++entry;
+			if (failed)
+			{
+				dropClient(fd);
+			}
+		}
+	}
+
+	interval = {};
+	timerfd_settime(timerFd, 0, &interval, nullptr);
+}
+
+//Makes run return; safe to call from any thread and from a signal handler
+void matchServer::stop()
+{
+	stopping.store(true, std::memory_order_relaxed);
+	std::uint64_t wake = 1;
+	write(wakeFd, &wake, sizeof(wake));
+}
+
+//Returns the totals of the run so far, counting the bytes of the clients still connected; only consistent once run has returned
+serverStats matchServer::returnStats() const
+{
+	serverStats totals = stats;
+	for (const auto &entry : clients)
+	{
+		totals.bytesSent += entry.second.link->returnBytesSent();
+		totals.bytesReceived += entry.second.link->returnBytesReceived();
+	}
+	return totals;
+}
+
+//Accepts every client waiting on the listening socket
+void matchServer::acceptClients()
+{
+	while (true)
+	{
+		int fd = acceptSocket(listenFd);
+		if (fd < 0)
+		{
+			return;
+		}
+
+		client &joined = clients[fd];
+		joined.link.reset(new connection(fd));
+		watch(fd, EPOLLIN, true);
+	}
+}
+
+//Reads and handles the messages of a client, and sends it what is queued once its socket takes more
+void matchServer::handleClient(int fd, std::uint32_t events)
+{
+	auto found = clients.find(fd);
+	if (found == clients.end() || found->second.failed)
+	{
+		return;
+	}
+
+	client &sender = found->second;
+	if (events & EPOLLOUT)
+	{
+		flushClient(fd, sender);
+	}
+	if (!(events & (EPOLLIN | EPOLLHUP | EPOLLERR)))
+	{
+		return;
+	}
+
+	bool open = sender.link->receive();
+	try
+	{
+		const std::uint8_t *data;
+		std::size_t size;
+		while (sender.link->nextMessage(data, size))
+		{
+			byteReader in(data, size);
+			handleMessage(fd, sender, in);
+		}
+	}
+	catch(std::exception const &)
+	{
+		//A client sending something malformed is disconnected
+		open = false;
+	}
+
+	if (!open)
+	{
+		dropClient(fd);
+		return;
+	}
+	startMatches();
+	flushClient(fd, clients[fd]);
+}
+
+//Handles one message of a client
+void matchServer::handleMessage(int fd, client &sender, byteReader &in)
+{
+	std::uint8_t type = in.readByte();
+	if (type == messageHello)
+	{
+		readHello(in);
+		if (!sender.waiting && sender.matchId == 0)
+		{
+			sender.waiting = true;
+			waiting.push_back(fd);
+		}
+	}
+	else if (type == messageInput)
+	{
+		std::uint64_t sequence;
+		input frame = readInputFrame(in, sequence);
+		stats.inputFrames++;
+		auto running = matches.find(sender.matchId);
+		if (running == matches.end())
+		{
+			return;
+		}
+
+		//Every frame since the last tick goes into the next step, so no key press is lost however many arrive
+		player &target = running->second.players[sender.slot];
+		target.next.flags |= frame.flags;
+		target.next.repeats = std::max(target.next.repeats, frame.repeats);
+		target.lastInput = std::max(target.lastInput, sequence);
+	}
+	else
+	{
+		throw std::runtime_error("Unexpected message from a client");
+	}
+}
+
+//Closes a client's connection; a player that leaves a match loses it
+void matchServer::dropClient(int fd)
+{
+	auto found = clients.find(fd);
+	if (found == clients.end())
+	{
+		return;
+	}
+
+	client &leaving = found->second;
+	auto running = matches.find(leaving.matchId);
+	if (running != matches.end())
+	{
+		running->second.players[leaving.slot].left = true;
+		running->second.players[leaving.slot].client = -1;
+	}
+	if (leaving.waiting)
+	{
+		waiting.erase(std::find(waiting.begin(), waiting.end(), fd));
+	}
+	stats.bytesSent += leaving.link->returnBytesSent();
+	stats.bytesReceived += leaving.link->returnBytesReceived();
+
+	epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr);
+	clients.erase(found);
+}
+
+//Starts matches for the waiting clients, in the order they said hello, while there are enough of them
+void matchServer::startMatches()
+{
+	while (int(waiting.size()) >= options.playersPerMatch)
+	{
+		std::uint64_t id = nextMatchId++;
+		matchInfo info;
+		info.numPlayers = options.playersPerMatch;
+		info.seed = gameSeed(options.seed, stats.matchesStarted);
+		info.rules = options.rules;
+		stats.matchesStarted++;
+
+		match &started = matches[id];
+		started.holes.seed(info.seed);
+		for (int slot = 0; slot < info.numPlayers; slot++)
+		{
+			int fd = waiting.front();
+			waiting.pop_front();
+			client &joined = clients[fd];
+			joined.waiting = false;
+			joined.matchId = id;
+			joined.slot = slot;
+			joined.views.assign(info.numPlayers, playerView());
+			started.players.emplace_back(fd, gameState(info.seed, info.rules));
+
+			info.slot = slot;
+			writeMatchStart(joined.link->startMessage(), info);
+			joined.link->endMessage();
+		}
+	}
+}
+
+//Advances every match by one tick and ends the ones that were decided
+void matchServer::runTick()
+{
+	stats.ticks++;
+	for (auto running = matches.begin(); running != matches.end(); )
+	{
+		if (tickMatch(running->second))
+		{
+			++running;
+		}
+		else
+		{
+			stats.matchesFinished++;
+			running = matches.erase(running);
+		}
+	}
+}
+
+//Steps every game still being played, passes on the garbage of their line clears and sends every client the changes
+//Returns false once the match is over
+bool matchServer::tickMatch(match &running)
+{
+	running.tick++;
+	int numPlayers = running.players.size();
+	for (int slot = 0; slot < numPlayers; slot++)
+	{
+		player &playing = running.players[slot];
+		if (playing.left || playing.game.isGameOver())
+		{
+			continue;
+		}
+
+		stepResult result = playing.game.step(playing.next);
+		playing.next = input();
+		globalCounters.add(counterSteps);
+		globalCounters.add(counterLocks, result.locked);
+		globalCounters.add(counterLines, result.linesCleared);
+
+		//The game has already cancelled its own incoming garbage, and what is left goes to the next opponent still playing
+		int sent = result.attack;
+		for (int offset = 1; sent > 0 && offset < numPlayers; offset++)
+		{
+			player &target = running.players[(slot + offset) % numPlayers];
+			if (!target.left && !target.game.isGameOver())
+			{
+				target.game.receiveGarbage(sent, running.holes() % numColumns);
+				sent = 0;
+			}
+		}
+	}
+
+	int standing = 0;
+	int winner = -1;
+	for (int slot = 0; slot < numPlayers; slot++)
+	{
+		const player &playing = running.players[slot];
+		if (!playing.left && !playing.game.isGameOver())
+		{
+			standing++;
+			winner = slot;
+		}
+	}
+
+	for (const player &watching : running.players)
+	{
+		if (watching.client < 0)
+		{
+			continue;
+		}
+
+		client &receiver = clients[watching.client];
+		for (int slot = 0; slot < numPlayers; slot++)
+		{
+			const player &shown = running.players[slot];
+			std::vector<std::uint8_t> &message = receiver.link->startMessage();
+			if (writeUpdate(message, slot, running.tick, shown.lastInput, shown.game, receiver.views[slot]))
+			{
+				stats.updates++;
+				stats.updateBytes += message.size();
+				receiver.link->endMessage();
+			}
+		}
+	}
+
+	//A match of one player lasts until that player loses, and a versus match until one player is left
+	bool timeUp = options.maxMatchTicks > 0 && running.tick >= options.maxMatchTicks;
+	if (standing > (numPlayers > 1 ? 1 : 0) && !timeUp)
+	{
+		return true;
+	}
+
+	if (timeUp)
+	{
+		winner = -1;
+		int best = -1;
+		for (int slot = 0; slot < numPlayers; slot++)
+		{
+			const player &playing = running.players[slot];
+			if (!playing.left && !playing.game.isGameOver() && playing.game.returnScore() > best)
+			{
+				best = playing.game.returnScore();
+				winner = slot;
+			}
+		}
+	}
+	endMatch(running, winner);
+	return false;
+}
+
+//Tells every client still in a match who won and frees them to say hello again
+void matchServer::endMatch(match &running, int winner)
+{
+	for (const player &playing : running.players)
+	{
+		if (playing.client < 0)
+		{
+			continue;
+		}
+
+		client &receiver = clients[playing.client];
+		writeMatchEnd(receiver.link->startMessage(), winner);
+		receiver.link->endMessage();
+		receiver.matchId = 0;
+		receiver.slot = -1;
+		receiver.views.clear();
+	}
+}
+
+//Sends a client what the socket takes and watches for it taking more only while something is left
+//A client whose connection failed, or that has more than maxPendingBytes waiting, is marked to be dropped by the event loop
+void matchServer::flushClient(int fd, client &receiver)
+{
+	if (receiver.failed)
+	{
+		return;
+	}
+	if (!receiver.link->flush())
+	{
+		receiver.failed = true;
+		return;
+	}
+	if (receiver.link->returnPendingBytes() > options.maxPendingBytes)
+	{
+		//Its queue would otherwise grow by every update for as long as its match runs
+		receiver.failed = true;
+		stats.stalledClients++;
+		return;
+	}
+
+	bool pending = receiver.link->hasPending();
+	if (pending != receiver.watchingWrites)
+	{
+		receiver.watchingWrites = pending;
+		watch(fd, pending ? EPOLLIN | EPOLLOUT : EPOLLIN, false);
+	}
+}
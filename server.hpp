@@ -0,0 +1,129 @@
+#ifndef SERVER_HPP
+#define SERVER_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "game.hpp"
+#include "net.hpp"
+#include "protocol.hpp"
+
+//Settings of a match server
+struct serverOptions
+{
+	//unix:PATH or HOST:PORT
+	std::string address = "unix:/tmp/tetris.sock";
+	int playersPerMatch = 2;
+	std::uint64_t seed = 1;
+	gameRules rules;
+	int tickRate = ticksPerSecond;
+	//Ticks after which a match ends with the highest score winning, 0 for no limit
+	std::uint64_t maxMatchTicks = 0;
+	//Bytes queued for a client that is not reading them before it is dropped
+	std::size_t maxPendingBytes = 256 * 1024;
+};
+
+//Totals of a server run
+struct serverStats
+{
+	std::uint64_t ticks = 0;
+	//Ticks the timer fired for that were dropped because the server fell too far behind
+	std::uint64_t droppedTicks = 0;
+	std::uint64_t matchesStarted = 0;
+	std::uint64_t matchesFinished = 0;
+	std::uint64_t inputFrames = 0;
+	std::uint64_t updates = 0;
+	std::uint64_t updateBytes = 0;
+	std::uint64_t bytesSent = 0;
+	std::uint64_t bytesReceived = 0;
+	//Clients dropped for letting more than maxPendingBytes queue up
+	std::uint64_t stalledClients = 0;
+};
+
+/* Authoritative server of versus matches, on one thread driven by an epoll loop
+Clients that say hello wait until enough of them are waiting to fill a match, and then play it on the server: every
+player's game has the same seed, steps once a tick of a timerfd at the tick rate with the input frames that came in
+since the last tick, and sends the attack of its clears to an opponent as garbage. After every tick each client is sent a
+delta of every game of its match against what it was sent before, and once one player is left standing it is told
+who won and can say hello again for another match */
+class matchServer
+{
+	private:
+		struct player
+		{
+			int client;
+			gameState game;
+			//Input frames received since the last tick, merged
+			input next;
+			std::uint64_t lastInput = 0;
+			bool left = false;
+
+			player(int setClient, const gameState &setGame) : client(setClient), game(setGame)
+			{
+			}
+		};
+
+		struct match
+		{
+			std::vector<player> players;
+			std::uint64_t tick = 0;
+			//Picks the hole column of every batch of garbage, from the match's seed
+			std::minstd_rand holes;
+		};
+
+		struct client
+		{
+			std::unique_ptr<connection> link;
+			std::uint64_t matchId = 0;
+			int slot = -1;
+			bool waiting = false;
+			bool watchingWrites = false;
+			bool failed = false;
+			//What the client was last sent of every game of its match
+			std::vector<playerView> views;
+		};
+
+		serverOptions options;
+		int listenFd = -1;
+		int epollFd = -1;
+		int timerFd = -1;
+		int wakeFd = -1;
+		std::unordered_map<int, client> clients;
+		//Ordered so that matches always tick in the order they started
+		std::map<std::uint64_t, match> matches;
+		std::deque<int> waiting;
+		std::uint64_t nextMatchId = 1;
+		std::atomic<bool> stopping{false};
+		serverStats stats;
+
+		void closeAll();
+		void watch(int fd, std::uint32_t events, bool add);
+		void acceptClients();
+		void handleClient(int fd, std::uint32_t events);
+		void handleMessage(int fd, client &sender, byteReader &in);
+		void dropClient(int fd);
+		void startMatches();
+		void runTick();
+		bool tickMatch(match &running);
+		void endMatch(match &running, int winner);
+		void flushClient(int fd, client &receiver);
+
+	public:
+		matchServer(const serverOptions &setOptions);
+		~matchServer();
+		matchServer(const matchServer &) = delete;
+		matchServer &operator=(const matchServer &) = delete;
+
+		void run();
+		void stop();
+		serverStats returnStats() const;
+};
+
+#endif
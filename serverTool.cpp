@@ -0,0 +1,282 @@
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include "client.hpp"
+#include "policy.hpp"
+#include "server.hpp"
+
+//Options of a server run
+struct toolOptions
+{
+	serverOptions server;
+	//Clients started in this process, each playing matches matches; with none the server runs until interrupted
+	int bots = 0;
+	int matches = 1;
+	policyType policy = policyRandom;
+	//Clients that say hello and then never read, which the server should drop while the bots' matches go on
+	int stalled = 0;
+};
+
+//Totals of one bot, written only by its own thread
+struct alignas(64) botTotals
+{
+	std::uint64_t matches = 0;
+	std::uint64_t wins = 0;
+	std::uint64_t updates = 0;
+	std::uint64_t hashMismatches = 0;
+	std::uint64_t bytesSent = 0;
+	std::uint64_t bytesReceived = 0;
+	bool failed = false;
+};
+
+//Server stopped by SIGINT and SIGTERM
+matchServer *runningServer = nullptr;
+
+//Stops the running server from a signal handler
+void stopServer(int)
+{
+	if (runningServer)
+	{
+		runningServer->stop();
+	}
+}
+
+//Prints how to call the server
+void printUsage()
+{
+	std::cerr << "Usage: tetris_server [--listen unix:PATH|HOST:PORT] [--players N] [--seed S] [--tick-rate hz] [--max-match-ticks T] [--lock-delay ticks] [--bots N] [--matches M] [--policy idle|random] [--stalled N] [--max-pending bytes]\n";
+}
+
+//Reads the options from the command line
+toolOptions parseOptions(int argc, char **argv)
+{
+	toolOptions options;
+	for (int i = 1; i < argc; i++)
+	{
+		std::string arg = argv[i];
+		if (i + 1 >= argc)
+		{
+			throw std::runtime_error("Missing value for " + arg);
+		}
+
+		std::string value = argv[++i];
+		if (arg == "--listen")
+		{
+			options.server.address = value;
+		}
+		else if (arg == "--players")
+		{
+			options.server.playersPerMatch = std::stoi(value);
+		}
+		else if (arg == "--seed")
+		{
+			options.server.seed = std::stoull(value);
+		}
+		else if (arg == "--tick-rate")
+		{
+			options.server.tickRate = std::stoi(value);
+		}
+		else if (arg == "--max-match-ticks")
+		{
+			options.server.maxMatchTicks = std::stoull(value);
+		}
+		else if (arg == "--lock-delay")
+		{
+			options.server.rules.lockDelay = std::stoi(value);
+		}
+		else if (arg == "--bots")
+		{
+			options.bots = std::stoi(value);
+		}
+		else if (arg == "--matches")
+		{
+			options.matches = std::stoi(value);
+		}
+		else if (arg == "--policy")
+		{
+			options.policy = parsePolicy(value);
+		}
+		else if (arg == "--stalled")
+		{
+			options.stalled = std::stoi(value);
+		}
+		else if (arg == "--max-pending")
+		{
+			options.server.maxPendingBytes = std::stoull(value);
+		}
+		else
+		{
+			throw std::runtime_error("Unknown option " + arg);
+		}
+	}
+
+	//Every bot plays every match, so the bots must fill whole matches; stalled clients take the place of bots in the
+	//first ones and never come back, so with them every bot plays one match
+	if ((options.bots + options.stalled) % options.server.playersPerMatch != 0)
+	{
+		throw std::runtime_error("The number of bots and stalled clients must be a multiple of the players per match");
+	}
+	if (options.stalled > 0 && options.matches != 1)
+	{
+		throw std::runtime_error("With stalled clients every bot plays one match");
+	}
+	if (options.stalled >= options.server.playersPerMatch)
+	{
+		throw std::runtime_error("Every match needs a bot, so there must be fewer stalled clients than players per match");
+	}
+	if (options.policy == policyAi)
+	{
+		throw std::runtime_error("Bots only see board updates, which the AI policy cannot plan from");
+	}
+
+	return options;
+}
+
+//Plays matches through a client, sending one input frame from the policy for every tick the server reports
+void playBot(const toolOptions &options, int index, botTotals &totals)
+{
+	try
+	{
+		matchClient client(options.server.address);
+		inputPolicy policy(options.policy, unsigned(options.server.seed + index));
+		std::uint64_t seenTick = 0;
+		while (client.returnMatchesPlayed() < std::uint64_t(options.matches))
+		{
+			std::uint64_t played = client.returnMatchesPlayed();
+			if (!client.poll(10))
+			{
+				totals.failed = true;
+				break;
+			}
+
+			if (client.returnMatchesPlayed() != played)
+			{
+				totals.wins += client.returnWinner() == client.returnInfo().slot;
+				seenTick = 0;
+				if (client.returnMatchesPlayed() < std::uint64_t(options.matches))
+				{
+					client.requeue();
+				}
+			}
+			else if (client.isInMatch())
+			{
+				const playerView &own = client.returnView(client.returnInfo().slot);
+				if (own.tick != seenTick && !own.gameOver)
+				{
+					seenTick = own.tick;
+					client.sendInput(policy.nextBlindInput());
+				}
+			}
+		}
+
+		totals.matches = client.returnMatchesPlayed();
+		totals.updates = client.returnUpdates();
+		totals.hashMismatches = client.returnHashMismatches();
+		totals.bytesSent = client.returnBytesSent();
+		totals.bytesReceived = client.returnBytesReceived();
+	}
+	catch(std::exception const &e)
+	{
+		std::cerr << "Exception: " << e.what() << "\n";
+		totals.failed = true;
+	}
+}
+
+int main(int argc, char **argv)
+{
+	toolOptions options;
+	try
+	{
+		options = parseOptions(argc, argv);
+	}
+	catch(std::exception const &e)
+	{
+		std::cerr << "Exception: " << e.what() << "\n";
+		printUsage();
+		return 1;
+	}
+
+	try
+	{
+		matchServer server(options.server);
+		runningServer = &server;
+		std::signal(SIGINT, stopServer);
+		std::signal(SIGTERM, stopServer);
+		std::cout << "listening    " << options.server.address << " at " << options.server.tickRate << " ticks/s\n";
+
+		auto start = std::chrono::steady_clock::now();
+		std::vector<botTotals> bots(options.bots);
+		std::thread serverThread([&]()
+		{
+			server.run();
+		});
+		std::vector<std::thread> botThreads;
+		for (int i = 0; i < options.bots; i++)
+		{
+			botThreads.emplace_back(playBot, std::cref(options), i, std::ref(bots[i]));
+		}
+		std::vector<std::unique_ptr<matchClient>> stalled;
+		for (int i = 0; i < options.stalled; i++)
+		{
+			stalled.emplace_back(new matchClient(options.server.address));
+		}
+		for (int i = 0; i < botThreads.size(); i++)
+		{
+			botThreads[i].join();
+		}
+		if (options.bots > 0)
+		{
+			server.stop();
+		}
+		serverThread.join();
+		runningServer = nullptr;
+		double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		serverStats stats = server.returnStats();
+		std::cout << "ran          " << stats.ticks << " ticks in " << seconds << " s, " << stats.droppedTicks << " dropped\n";
+		std::cout << "matches      " << stats.matchesFinished << " of " << stats.matchesStarted << " finished\n";
+		std::cout << "inputs       " << stats.inputFrames << " frames\n";
+		std::cout << "updates      " << stats.updates << " in " << stats.updateBytes << " bytes, mean " << (stats.updates ? double(stats.updateBytes) / stats.updates : 0) << " bytes\n";
+		std::cout << "traffic      " << stats.bytesSent << " bytes sent, " << stats.bytesReceived << " received\n";
+		std::cout << "stalled      " << stats.stalledClients << " clients dropped for not reading\n";
+		if (options.bots == 0)
+		{
+			return 0;
+		}
+
+		botTotals total;
+		for (int i = 0; i < options.bots; i++)
+		{
+			total.matches += bots[i].matches;
+			total.wins += bots[i].wins;
+			total.updates += bots[i].updates;
+			total.hashMismatches += bots[i].hashMismatches;
+			total.bytesSent += bots[i].bytesSent;
+			total.failed = total.failed || bots[i].failed;
+		}
+		std::cout << "bots         " << options.bots << " played " << total.matches << " matches, " << total.wins << " wins, " << total.updates << " updates received\n";
+		std::cout << "input frame  mean " << (stats.inputFrames ? double(total.bytesSent) / stats.inputFrames : 0) << " bytes with framing\n";
+		if (total.failed || total.hashMismatches > 0)
+		{
+			std::cout << "bots failed or rebuilt " << total.hashMismatches << " boards that did not match the server\n";
+			return 1;
+		}
+		if (stats.stalledClients != std::uint64_t(options.stalled) || total.matches != std::uint64_t(options.bots) * options.matches)
+		{
+			std::cout << "the server dropped " << stats.stalledClients << " of " << options.stalled << " stalled clients\n";
+			return 1;
+		}
+	}
+	catch(std::exception const &e)
+	{
+		std::cerr << "Exception: " << e.what() << "\n";
+		return 1;
+	}
+}
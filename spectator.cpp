@@ -0,0 +1,151 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <string>
+#include "renderer.hpp"
+#include "spectator.hpp"
+
+//Constructor laying the boards out in a square grid that fits in maxHeight pixels and building their frames
+spectatorView::spectatorView(int setNumBoards, float maxHeight) : numBoards(setNumBoards), gap(2), frameBuffer(sf::Quads, sf::VertexBuffer::Static), frameArray(sf::Quads), fills(sf::Quads)
+{
+	boardsPerRow = std::ceil(std::sqrt(float(numBoards)));
+	int boardsPerColumn = (numBoards + boardsPerRow - 1) / boardsPerRow;
+	cellSize = std::max(1.f, std::floor((maxHeight - gap * (boardsPerColumn + 1)) / (boardsPerColumn * numRows)));
+
+	//A dark background with a one pixel border around every board
+	sf::Color background(24, 24, 24);
+	sf::Color border(96, 96, 96);
+	float boardWidth = numColumns * cellSize;
+	float boardHeight = numRows * cellSize;
+	for (int i = 0; i < numBoards; i++)
+	{
+		sf::Vector2f origin = returnBoardOrigin(i);
+		appendQuad(frameArray, origin.x, origin.y, boardWidth, boardHeight, background);
+		appendQuad(frameArray, origin.x - 1, origin.y - 1, boardWidth + 2, 1, border);
+		appendQuad(frameArray, origin.x - 1, origin.y + boardHeight, boardWidth + 2, 1, border);
+		appendQuad(frameArray, origin.x - 1, origin.y, 1, boardHeight, border);
+		appendQuad(frameArray, origin.x + boardWidth, origin.y, 1, boardHeight, border);
+	}
+	useFrameBuffer = sf::VertexBuffer::isAvailable() && frameBuffer.create(frameArray.getVertexCount()) && frameBuffer.update(&frameArray[0]);
+
+	//Room for every cell of every board so filling never reallocates
+	fills.resize(4 * numColumns * numRows * numBoards);
+	fills.clear();
+}
+
+//Returns the top left corner of a board in the window
+sf::Vector2f spectatorView::returnBoardOrigin(int board) const
+{
+	int column = board % boardsPerRow;
+	int row = board / boardsPerRow;
+	return sf::Vector2f(gap + column * (numColumns * cellSize + gap), gap + row * (numRows * cellSize + gap));
+}
+
+//Returns the width in pixels of the whole wall
+unsigned spectatorView::returnWidth() const
+{
+	return gap + boardsPerRow * (numColumns * cellSize + gap);
+}
+
+//Returns the height in pixels of the whole wall
+unsigned spectatorView::returnHeight() const
+{
+	int boardsPerColumn = (numBoards + boardsPerRow - 1) / boardsPerRow;
+	return gap + boardsPerColumn * (numRows * cellSize + gap);
+}
+
+//Rewrites the blocks of every game into the shared quad array
+void spectatorView::update(const std::vector<gameState> &games)
+{
+	fills.clear();
+	for (int i = 0; i < games.size() && i < numBoards; i++)
+	{
+		sf::Vector2f origin = returnBoardOrigin(i);
+		appendGameFills(fills, games[i], origin.x, origin.y, cellSize);
+	}
+}
+
+//Draws every board frame and then every block
+void spectatorView::draw(sf::RenderTarget &target, sf::RenderStates states) const
+{
+	if (useFrameBuffer)
+	{
+		target.draw(frameBuffer, states);
+	}
+	else
+	{
+		target.draw(frameArray, states);
+	}
+
+	if (fills.getVertexCount() > 0)
+	{
+		target.draw(fills, states);
+	}
+}
+
+//Opens a window showing numBoards headless games played by the given policy under the given rules until it is closed
+//Games that are lost start over; the window title shows the frame rate
+//The window is redrawn at frameLimit frames per second, or with vertical sync when it is 0
+void runSpectator(int numBoards, policyType policy, unsigned seed, int frameLimit, const aiOptions &ai, const gameRules &rules)
+{
+	spectatorView view(numBoards, 1000);
+	sf::RenderWindow window(sf::VideoMode(view.returnWidth(), view.returnHeight()), "Tetris Clone - Spectator");
+	configFrameRate(window, frameLimit);
+
+	std::vector<gameState> games;
+	std::vector<inputPolicy> policies;
+	games.reserve(numBoards);
+	policies.reserve(numBoards);
+	for (int i = 0; i < numBoards; i++)
+	{
+		games.push_back(gameState(gameSeed(seed, i), rules));
+		policies.push_back(inputPolicy(policy, gameSeed(seed, i), ai));
+	}
+
+	const std::chrono::nanoseconds tickLength(1000000000 / ticksPerSecond);
+	std::chrono::nanoseconds accumulator(0);
+	auto lastFrame = std::chrono::steady_clock::now();
+	auto lastTitle = lastFrame;
+	int frames = 0;
+	while (window.isOpen())
+	{
+		sf::Event event;
+		while (window.pollEvent(event))
+		{
+			if (event.type == sf::Event::Closed)
+			{
+				window.close();
+			}
+		}
+
+		//Step every game by as many fixed steps as have elapsed, catching up on at most a few
+		auto now = std::chrono::steady_clock::now();
+		accumulator = std::min<std::chrono::nanoseconds>(accumulator + (now - lastFrame), 8 * tickLength);
+		lastFrame = now;
+		while (accumulator >= tickLength)
+		{
+			accumulator -= tickLength;
+			for (int i = 0; i < numBoards; i++)
+			{
+				games[i].step(policies[i].nextInput(games[i]));
+				if (games[i].isGameOver())
+				{
+					games[i].restart();
+				}
+			}
+		}
+
+		view.update(games);
+		window.clear();
+		window.draw(view);
+		window.display();
+
+		frames++;
+		if (now - lastTitle >= std::chrono::seconds(1))
+		{
+			window.setTitle("Tetris Clone - Spectator - " + std::to_string(numBoards) + " boards - " + std::to_string(frames) + " fps");
+			frames = 0;
+			lastTitle = now;
+		}
+	}
+}
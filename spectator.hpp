@@ -0,0 +1,37 @@
+#ifndef SPECTATOR_HPP
+#define SPECTATOR_HPP
+
+#include <vector>
+#include <SFML/Graphics.hpp>
+#include "game.hpp"
+#include "policy.hpp"
+
+//Wall of miniature boards showing many games in one window
+//The backgrounds and borders of every board share one static vertex buffer built up front,
+//and the blocks of every game are written into one quad array per frame, so a frame is two draw calls
+class spectatorView : public sf::Drawable
+{
+	private:
+		int numBoards;
+		int boardsPerRow;
+		float cellSize;
+		float gap;
+		sf::VertexBuffer frameBuffer;
+		sf::VertexArray frameArray;
+		bool useFrameBuffer;
+		sf::VertexArray fills;
+
+		void draw(sf::RenderTarget &target, sf::RenderStates states) const override;
+
+	public:
+		spectatorView(int setNumBoards, float maxHeight);
+
+		sf::Vector2f returnBoardOrigin(int board) const;
+		unsigned returnWidth() const;
+		unsigned returnHeight() const;
+		void update(const std::vector<gameState> &games);
+};
+
+void runSpectator(int numBoards, policyType policy, unsigned seed, int frameLimit, const aiOptions &ai = aiOptions(), const gameRules &rules = gameRules());
+
+#endif
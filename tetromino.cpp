@@ -0,0 +1,298 @@
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+#include "tetromino.hpp"
+
+//Function to move a block in an arbitrary direction
+//0 is up, 1 is left, 2 is down, 3 is right
+void block::move(int dir)
+{
+	if (dir == 0)
+	{
+		p.y--;
+	}
+	else if (dir == 1)
+	{
+		p.x--;
+	}
+	else if (dir == 2)
+	{
+		p.y++;
+	}
+	else if (dir == 3)
+	{
+		p.x++;
+	}
+}
+
+//Sets a blocks position to an arbitrary point
+void block::setPosition(int x, int y)
+{
+	p.x = x;
+	p.y = y;
+}
+
+//Returns a block's position object
+position block::returnPosition() const
+{
+	return p;
+}
+
+//Sets a blocks color to an arbitrary board color index
+void block::setColor(std::uint8_t color)
+{
+	blockColor = color;
+}
+
+//Returns a block's board color index
+std::uint8_t block::returnColor() const
+{
+	return blockColor;
+}
+
+//Constructor setting the shape ID, the x and y coordinates, and the default rotation
+//Tetrominos spawn in the middle column, which depends on the width of the board
+tetromino::tetromino(int setShape, int spawnX)
+{
+	shape = setShape;
+	p.x = spawnX;
+	p.y = 0;
+	rotation = 0;
+}
+
+//Move a whole tetromino in an arbitrary direction
+//0: Up, 1: Left, 2: Down, 3: Right
+void tetromino::move(int direction)
+{
+	try
+	{
+		if (direction < 0 || direction > 3)
+		{
+			throw std::runtime_error("Move direction out of bounds");
+		}
+
+		if (direction == 0)
+		{
+			p.y--;
+		}
+		else if (direction == 1)
+		{
+			p.x--;
+		}
+		else if (direction == 2)
+		{
+			p.y++;
+		}
+		else
+		{
+			p.x++;
+		}
+	}
+	catch(std::exception const &e)
+	{
+		std::cerr << "Exception: " << e.what() << "\n";
+	}
+}
+
+//Return the position of the tetromino
+position tetromino::returnPosition() const
+{
+	return p;
+}
+//Rotate a whole tetromino in an arbitrary direction
+//-1: Counter-clockwise, 1: Clockwise, 2: Half turn
+void tetromino::rotate(int direction)
+{
+	try
+	{
+		if (direction != -1 && direction != 1 && direction != 2)
+		{
+			throw std::runtime_error("Rotation direction out of bounds");
+		}
+
+		//Adding numRotations keeps counter-clockwise rotation from going negative
+		rotation = (rotation + direction + numRotations) % numRotations;
+	}
+	catch(std::exception const &e)
+	{
+		std::cerr << "Exception: " << e.what() << "\n";
+	}
+}
+
+//Puts the tetromino at an arbitrary position and rotation
+void tetromino::setPlacement(int x, int y, int setRotation)
+{
+	p.x = x;
+	p.y = y;
+	rotation = (setRotation % numRotations + numRotations) % numRotations;
+}
+
+//Decomposes the tetromino into the blocks that make it up and locks them into the board
+template <class boardType>
+void tetromino::decompose(boardType &field) const
+{
+	const pieceLayout &layout = returnLayout(shape, rotation);
+	for (int i = 0; i < blocksPerPiece; i++)
+	{
+		field.fillCell(layout.cells[i].x + p.x, layout.cells[i].y + p.y, shape + 1);
+	}
+}
+
+//Returns the shape ID of the tetromino
+int tetromino::returnShape() const
+{
+	return shape;
+}
+
+//Returns the rotation of the tetromino
+int tetromino::returnRotation() const
+{
+	return rotation;
+}
+
+//Returns block i of the tetromino placed at its board position
+block tetromino::returnBlock(int i) const
+{
+	const cellOffset &offset = returnLayout(shape, rotation).cells[i];
+	block tempBlock;
+	tempBlock.setPosition(offset.x + p.x, offset.y + p.y);
+	tempBlock.setColor(shape + 1);
+	return tempBlock;
+}
+
+//Returns whether or not the active tetromino can move in a specified direction
+//0: Up, 1: Left, 2: Down, 3: Right
+template <class boardType>
+bool canMove(const tetromino &activeTet, const boardType &field, int direction)
+{
+	int dx = 0;
+	int dy = 0;
+	if (direction == 0)
+	{
+		//TODO eventually; currently a piece will never go up
+		return false;
+	}
+	else if (direction == 1)
+	{
+		dx = -1;
+	}
+	else if (direction == 2)
+	{
+		dy = 1;
+	}
+	else if (direction == 3)
+	{
+		dx = 1;
+	}
+	//Called when an invalid direction is passed
+	else
+	{
+		return false;
+	}
+
+	//Check border and tetromino collision with one mask test per row of the piece
+	return pieceFits(field, activeTet.returnShape(), activeTet.returnRotation(), activeTet.returnPosition().x + dx, activeTet.returnPosition().y + dy);
+}
+
+//Returns the index of the first SRS kick that lets the active tetromino turn in a direction, -1 if none does
+//Every kick is one mask test per row of the piece
+//1: Clockwise, -1: Counter-clockwise, 2: Half turn
+template <class boardType>
+int findKick(const tetromino &activeTet, const boardType &field, int direction)
+{
+	int shape = activeTet.returnShape();
+	int target = (activeTet.returnRotation() + direction + numRotations) % numRotations;
+	position p = activeTet.returnPosition();
+	const kickList &list = returnKicks(shape, activeTet.returnRotation(), direction);
+	for (int i = 0; i < list.count; i++)
+	{
+		if (pieceFits(field, shape, target, p.x + list.tests[i].x, p.y + list.tests[i].y))
+		{
+			return i;
+		}
+	}
+
+	return -1;
+}
+
+//Returns whether or not the active tetromino can rotate in a specified direction, with a kick if it needs one
+//1: Clockwise, -1: Counter-clockwise, 2: Half turn
+template <class boardType>
+bool canRotate(const tetromino &activeTet, const boardType &field, int direction)
+{
+	return findKick(activeTet, field, direction) >= 0;
+}
+
+//Turns the active tetromino in a direction and moves it by the first kick it fits with, whose index goes in usedKick if given
+//Returns false and leaves it where it was when no kick fits
+template <class boardType>
+bool rotateWithKicks(tetromino &activeTet, const boardType &field, int direction, int *usedKick)
+{
+	int kick = findKick(activeTet, field, direction);
+	if (kick < 0)
+	{
+		return false;
+	}
+	if (usedKick)
+	{
+		*usedKick = kick;
+	}
+
+	const cellOffset &offset = returnKicks(activeTet.returnShape(), activeTet.returnRotation(), direction).tests[kick];
+	position p = activeTet.returnPosition();
+	activeTet.setPlacement(p.x + offset.x, p.y + offset.y, activeTet.returnRotation() + direction);
+	return true;
+}
+
+//Returns whether locking the tetromino where it is would leave a block above the top row, which loses the game
+bool isLockedOut(const tetromino &activeTet)
+{
+	return activeTet.returnPosition().y + returnLayout(activeTet.returnShape(), activeTet.returnRotation()).minY < 0;
+}
+
+//Returns how many rows the active tetromino can fall before it lands, one bit scan per column it covers
+//The first filled cell below the lowest block of every column stops it, or the floor where there is none
+template <class boardType>
+int dropDistance(const tetromino &activeTet, const boardType &field)
+{
+	typedef typename boardType::columnMask columnMask;
+	const pieceLayout &layout = returnLayout(activeTet.returnShape(), activeTet.returnRotation());
+	int left = activeTet.returnPosition().x + layout.minX;
+	int top = activeTet.returnPosition().y + layout.minY;
+	if (left < 0 || left + layout.width > boardType::width)
+	{
+		return 0;
+	}
+
+	int distance = boardType::height;
+	for (int i = 0; i < layout.width; i++)
+	{
+		int bottom = top + layout.columnBottoms[i];
+		columnMask below = field.returnColumn(left + i);
+		if (bottom >= 0)
+		{
+			below &= ~lowBits<columnMask>(bottom + 1);
+		}
+
+		int landing = below ? lowestSetBit(below) : boardType::height;
+		distance = std::min(distance, landing - bottom - 1);
+	}
+
+	return std::max(distance, 0);
+}
+
+//Every board size the game is instantiated for, matching the list in game.cpp
+#define INSTANTIATE_PIECE_MOVES(width, height) \
+	template void tetromino::decompose(basicBoard<width, height> &field) const; \
+	template bool canMove(const tetromino &activeTet, const basicBoard<width, height> &field, int direction); \
+	template int findKick(const tetromino &activeTet, const basicBoard<width, height> &field, int direction); \
+	template bool canRotate(const tetromino &activeTet, const basicBoard<width, height> &field, int direction); \
+	template bool rotateWithKicks(tetromino &activeTet, const basicBoard<width, height> &field, int direction, int *usedKick); \
+	template int dropDistance(const tetromino &activeTet, const basicBoard<width, height> &field);
+
+INSTANTIATE_PIECE_MOVES(10, 20)
+INSTANTIATE_PIECE_MOVES(10, 40)
+INSTANTIATE_PIECE_MOVES(16, 20)
+INSTANTIATE_PIECE_MOVES(16, 40)
+
+#undef INSTANTIATE_PIECE_MOVES
@@ -0,0 +1,90 @@
+#ifndef TETROMINO_HPP
+#define TETROMINO_HPP
+
+#include <cstdint>
+#include "board.hpp"
+#include "pieces.hpp"
+
+//Structure representing a (x, y) coordinate pair/
+struct position
+{
+	int x, y;
+};
+
+//Blocks that represent each filled cell on the map
+class block
+{
+	private:
+		position p;
+		//Board color index, 0 until a color is set
+		std::uint8_t blockColor = 0;
+	public:
+		void move(int dir);
+		//Set position must be called
+		void setPosition(int x, int y);
+		position returnPosition() const;
+		void setColor(std::uint8_t color);
+		std::uint8_t returnColor() const;
+};
+
+//Tetrominos are a shape in a rotation at a position
+//The blocks making them up are read from the precomputed piece tables
+class tetromino
+{
+	private:
+		position p;
+		/* Shape IDs
+		0: I
+		1: O
+		2: T
+		3: J
+		4: L
+		5: S
+		6: Z */
+		int shape;
+		/* Rotation values
+		0: 0 degrees
+		1: 90 degrees
+		2: 180 degrees
+		3: 270 degrees */
+		int rotation;
+
+	public:
+		tetromino(int setShape, int spawnX = numColumns / 2);
+
+		/* Move directions
+		0: Up
+		1: Left
+		2: Down
+		3: Right */
+		void move(int direction);
+		position returnPosition() const;
+		/* Rotate directions
+		-1: Counter-clockwise
+		1: Clockwise
+		2: Half turn */
+		void rotate(int direction);
+		void setPlacement(int x, int y, int setRotation);
+
+		template <class boardType>
+		void decompose(boardType &field) const;
+
+		int returnShape() const;
+		int returnRotation() const;
+		block returnBlock(int i) const;
+};
+
+//The functions taking a board are defined for every board size the game is instantiated for, listed in tetromino.cpp
+template <class boardType>
+bool canMove(const tetromino &activeTet, const boardType &field, int direction);
+template <class boardType>
+int findKick(const tetromino &activeTet, const boardType &field, int direction);
+template <class boardType>
+bool canRotate(const tetromino &activeTet, const boardType &field, int direction);
+template <class boardType>
+bool rotateWithKicks(tetromino &activeTet, const boardType &field, int direction, int *usedKick = nullptr);
+bool isLockedOut(const tetromino &activeTet);
+template <class boardType>
+int dropDistance(const tetromino &activeTet, const boardType &field);
+
+#endif
@@ -0,0 +1,155 @@
+#include <algorithm>
+#include "threadPool.hpp"
+
+//Constructor starting the worker threads, one per hardware thread when numThreads is 0
+workStealingPool::workStealingPool(int numThreads)
+{
+	if (numThreads <= 0)
+	{
+		numThreads = std::max(1u, std::thread::hardware_concurrency());
+	}
+
+	for (int i = 0; i < numThreads; i++)
+	{
+		queues.push_back(std::unique_ptr<workerQueue>(new workerQueue()));
+	}
+	for (int i = 0; i < numThreads; i++)
+	{
+		threads.emplace_back(&workStealingPool::workerLoop, this, i);
+	}
+}
+
+//Destructor waking every worker up to exit and joining them
+workStealingPool::~workStealingPool()
+{
+	{
+		std::lock_guard<std::mutex> guard(jobLock);
+		stopping = true;
+	}
+	jobStarted.notify_all();
+
+	for (int i = 0; i < threads.size(); i++)
+	{
+		threads[i].join();
+	}
+}
+
+//Returns the number of worker threads
+int workStealingPool::returnNumThreads() const
+{
+	return threads.size();
+}
+
+//Runs forRange over every item in [0, count) in ranges of at most grain items and returns once all of them are done
+//Only one thread may call this at a time
+void workStealingPool::parallelFor(std::uint64_t count, std::uint64_t grain, const rangeBody &forRange)
+{
+	if (count == 0)
+	{
+		return;
+	}
+
+	//Deal one contiguous share of the items to every worker to start with
+	std::uint64_t numWorkers = threads.size();
+	for (std::uint64_t i = 0; i < numWorkers; i++)
+	{
+		workRange share = {count * i / numWorkers, count * (i + 1) / numWorkers};
+		if (share.end > share.begin)
+		{
+			queues[i]->ranges.push_back(share);
+		}
+	}
+
+	std::unique_lock<std::mutex> guard(jobLock);
+	body = &forRange;
+	grainSize = std::max<std::uint64_t>(1, grain);
+	itemsLeft.store(count, std::memory_order_release);
+	workersBusy = numWorkers;
+	jobGeneration++;
+	jobStarted.notify_all();
+
+	jobFinished.wait(guard, [this] { return workersBusy == 0; });
+	body = nullptr;
+}
+
+//Waits for jobs and works on them until the pool is destroyed
+void workStealingPool::workerLoop(int worker)
+{
+	std::uint64_t seenGeneration = 0;
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> guard(jobLock);
+			jobStarted.wait(guard, [&] { return stopping || jobGeneration != seenGeneration; });
+			if (stopping)
+			{
+				return;
+			}
+			seenGeneration = jobGeneration;
+		}
+
+		workRange range;
+		while (itemsLeft.load(std::memory_order_acquire) > 0)
+		{
+			if (!popOwn(worker, range) && !steal(worker, range))
+			{
+				std::this_thread::yield();
+				continue;
+			}
+
+			//Keep the lower half and leave the upper half where a thief can take it
+			while (range.end - range.begin > grainSize)
+			{
+				std::uint64_t middle = range.begin + (range.end - range.begin) / 2;
+				{
+					std::lock_guard<std::mutex> guard(queues[worker]->lock);
+					queues[worker]->ranges.push_back({middle, range.end});
+				}
+				range.end = middle;
+			}
+
+			(*body)(worker, range.begin, range.end);
+			itemsLeft.fetch_sub(range.end - range.begin, std::memory_order_acq_rel);
+		}
+
+		std::lock_guard<std::mutex> guard(jobLock);
+		workersBusy--;
+		if (workersBusy == 0)
+		{
+			jobFinished.notify_all();
+		}
+	}
+}
+
+//Takes the most recently deferred range from the worker's own deque
+bool workStealingPool::popOwn(int worker, workRange &range)
+{
+	std::lock_guard<std::mutex> guard(queues[worker]->lock);
+	if (queues[worker]->ranges.empty())
+	{
+		return false;
+	}
+
+	range = queues[worker]->ranges.back();
+	queues[worker]->ranges.pop_back();
+	return true;
+}
+
+//Takes the oldest, and so largest, range from the first other worker that has one
+bool workStealingPool::steal(int worker, workRange &range)
+{
+	int numWorkers = queues.size();
+	for (int i = 1; i < numWorkers; i++)
+	{
+		workerQueue &victim = *queues[(worker + i) % numWorkers];
+		std::lock_guard<std::mutex> guard(victim.lock);
+		if (!victim.ranges.empty())
+		{
+			range = victim.ranges.front();
+			victim.ranges.pop_front();
+			return true;
+		}
+	}
+
+	return false;
+}
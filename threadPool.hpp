@@ -0,0 +1,62 @@
+#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//Range of work items [begin, end)
+struct workRange
+{
+	std::uint64_t begin, end;
+};
+
+//Pool of persistent worker threads that split ranges of work items between them
+//Each worker keeps its own deque of ranges; it splits the range it takes until it is no larger than the grain size,
+//pushing the halves it defers onto its own deque, and steals from the other deques once its own is empty
+class workStealingPool
+{
+	public:
+		//Called with the index of the worker running it and a range of at most grain items
+		typedef std::function<void(int worker, std::uint64_t begin, std::uint64_t end)> rangeBody;
+
+	private:
+		struct alignas(64) workerQueue
+		{
+			std::mutex lock;
+			std::deque<workRange> ranges;
+		};
+
+		std::vector<std::thread> threads;
+		std::vector<std::unique_ptr<workerQueue>> queues;
+
+		std::mutex jobLock;
+		std::condition_variable jobStarted;
+		std::condition_variable jobFinished;
+		std::uint64_t jobGeneration = 0;
+		int workersBusy = 0;
+		bool stopping = false;
+
+		const rangeBody *body = nullptr;
+		std::uint64_t grainSize = 1;
+		std::atomic<std::uint64_t> itemsLeft{0};
+
+		void workerLoop(int worker);
+		bool popOwn(int worker, workRange &range);
+		bool steal(int worker, workRange &range);
+
+	public:
+		workStealingPool(int numThreads = 0);
+		~workStealingPool();
+
+		int returnNumThreads() const;
+		void parallelFor(std::uint64_t count, std::uint64_t grain, const rangeBody &forRange);
+};
+
+#endif
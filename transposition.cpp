@@ -0,0 +1,96 @@
+#include <algorithm>
+#include <cstring>
+#include "board.hpp"
+#include "transposition.hpp"
+
+//Constructor making room for at least numEntries slots, rounding up to a power of two buckets
+transpositionTable::transpositionTable(int numEntries)
+{
+	std::uint64_t numBuckets = 1;
+	while (numBuckets * slotsPerBucket < std::uint64_t(std::max(numEntries, 1)))
+	{
+		numBuckets *= 2;
+	}
+
+	buckets.reset(new bucket[numBuckets]);
+	bucketMask = numBuckets - 1;
+}
+
+//Returns the key bits as they are stored; an empty slot decodes to 0, so no stored key is 0
+std::uint64_t transpositionTable::saltKey(std::uint64_t key) const
+{
+	std::uint64_t salted = (key ^ salt) & keyMask;
+	return salted ? salted : keyMask & -keyMask;
+}
+
+//Starts a new search, invalidating every stored value; no thread may be using the table while this is called
+void transpositionTable::newSearch()
+{
+	salt = mixBits(salt + 0x9E3779B97F4A7C15ull);
+	generation = generation == 255 ? 1 : generation + 1;
+}
+
+//Copies the value stored for a key in the current search into value, returning whether there was one
+bool transpositionTable::lookup(std::uint64_t key, double &value, transpositionStats &stats) const
+{
+	std::uint64_t salted = saltKey(key);
+	stats.probes++;
+
+	const bucket &keyBucket = buckets[(key ^ salt) & bucketMask];
+	for (int i = 0; i < slotsPerBucket; i++)
+	{
+		std::uint64_t data = keyBucket.slots[i].data.load(std::memory_order_relaxed);
+		std::uint64_t stored = keyBucket.slots[i].check.load(std::memory_order_relaxed) ^ data;
+		if ((stored & keyMask) == salted && ((stored >> 8) & 0xFF) == generation)
+		{
+			stats.hits++;
+			std::memcpy(&value, &data, sizeof(value));
+			return true;
+		}
+	}
+
+	return false;
+}
+
+//Stores the value of a key searched to the given depth in its own slot, an empty or stale one, or else in place of the
+//shallowest value of the current search
+void transpositionTable::store(std::uint64_t key, double value, int depth, transpositionStats &stats)
+{
+	std::uint64_t salted = saltKey(key);
+	stats.stores++;
+
+	std::uint64_t data;
+	std::memcpy(&data, &value, sizeof(data));
+	bucket &keyBucket = buckets[(key ^ salt) & bucketMask];
+	slot *own = nullptr;
+	slot *free = nullptr;
+	slot *shallowest = nullptr;
+	int shallowestDepth = 256;
+	for (int i = 0; i < slotsPerBucket && !own; i++)
+	{
+		std::uint64_t stored = keyBucket.slots[i].check.load(std::memory_order_relaxed) ^ keyBucket.slots[i].data.load(std::memory_order_relaxed);
+		if (((stored >> 8) & 0xFF) != generation)
+		{
+			free = free ? free : &keyBucket.slots[i];
+		}
+		else if ((stored & keyMask) == salted)
+		{
+			own = &keyBucket.slots[i];
+		}
+		else if (int(stored & 0xFF) < shallowestDepth)
+		{
+			shallowest = &keyBucket.slots[i];
+			shallowestDepth = stored & 0xFF;
+		}
+	}
+
+	slot *target = own ? own : free ? free : shallowest;
+	if (!own && !free)
+	{
+		stats.overwrites++;
+	}
+
+	std::uint64_t info = (generation << 8) | std::uint64_t(std::max(0, std::min(depth, 255)));
+	target->data.store(data, std::memory_order_relaxed);
+	target->check.store((salted | info) ^ data, std::memory_order_relaxed);
+}
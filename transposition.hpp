@@ -0,0 +1,74 @@
+#ifndef TRANSPOSITION_HPP
+#define TRANSPOSITION_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+//Counters of how a transposition table is used, for sizing it
+//Every search thread keeps its own and they are added up once the search is over, so probing never writes shared memory
+struct transpositionStats
+{
+	std::uint64_t probes = 0;
+	std::uint64_t hits = 0;
+	std::uint64_t stores = 0;
+	//Stores that replaced the value of another key stored during the same search
+	std::uint64_t overwrites = 0;
+
+	void add(const transpositionStats &other)
+	{
+		probes += other.probes;
+		hits += other.hits;
+		stores += other.stores;
+		overwrites += other.overwrites;
+	}
+
+	double returnHitRate() const
+	{
+		return probes ? double(hits) / probes : 0;
+	}
+};
+
+/* Bounded table of evaluations by board hash, shared by search threads without locks
+Every bucket is one cache line of slots. A slot holds the value and the key XORed with the value, so a slot two
+threads wrote at the same time fails the key check instead of returning another key's value; the low bits of the
+stored key are replaced by the search the slot was written in and the depth it was searched to
+A store takes the key's own slot, then a slot that is empty or left from an earlier search, and only then replaces
+the shallowest value of the current search, so that old entries never push out new ones */
+class transpositionTable
+{
+	private:
+		static constexpr int slotsPerBucket = 4;
+		//Low bits of a stored key holding the search and the depth instead
+		static constexpr std::uint64_t infoBits = 16;
+		static constexpr std::uint64_t keyMask = ~((std::uint64_t(1) << infoBits) - 1);
+
+		struct slot
+		{
+			std::atomic<std::uint64_t> check{0};
+			std::atomic<std::uint64_t> data{0};
+		};
+
+		struct alignas(64) bucket
+		{
+			slot slots[slotsPerBucket];
+		};
+
+		std::unique_ptr<bucket[]> buckets;
+		std::uint64_t bucketMask = 0;
+		//Mixed into every key, so that changing it invalidates the whole table without clearing it
+		std::uint64_t salt = 0;
+		//Search the table is used for, from 1 to 255; an empty slot reads as search 0, so it is never current
+		std::uint64_t generation = 1;
+
+		std::uint64_t saltKey(std::uint64_t key) const;
+
+	public:
+		transpositionTable(int numEntries);
+
+		void newSearch();
+		bool lookup(std::uint64_t key, double &value, transpositionStats &stats) const;
+		void store(std::uint64_t key, double value, int depth, transpositionStats &stats);
+};
+
+#endif